@@ -0,0 +1,449 @@
+#ifndef CUCKOOFILTER_BLOCKED_CUCKOO_FILTER_H
+#define CUCKOOFILTER_BLOCKED_CUCKOO_FILTER_H
+
+#include <type_traits>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "cuckoo_table.h"
+#include "../Utils/hash_function.h"
+#include "../Utils/util.h"
+
+#define BLOCKED_KICKS_MAX_COUNT 500
+// at most 1 / BLOCKED_OVERFLOW_RATIO of table entries can be stored in overflow area
+#define BLOCKED_OVERFLOW_RATIO 256
+
+
+/**
+ *
+ * Blocked cuckoo filter is a cuckoo filter in which both candidate buckets of an element lie in the same
+ * cache line. Table is split into blocks of CACHE_LINE_SIZE bytes and the secondary index is calculated
+ * by XOR-ing only the bits of the bucket position within the block, so every lookup, positive or
+ * negative, touches exactly one cache line instead of two.
+ *
+ * The price is the smaller choice of candidates during eviction: kicked fingerprints never leave their
+ * block, so the table is as full as its fullest block. Number of elements per block varies (binomially)
+ * and without further help the first full block would stop the whole filter at low load. Fingerprints
+ * that do not fit into their block are therefore kept in a small overflow area (at most
+ * 1 / BLOCKED_OVERFLOW_RATIO of the table), which is consulted only for blocks flagged as overflowed,
+ * so lookups of other blocks still touch a single cache line. Once the overflow area is full,
+ * insertion fails. The achievable load factor depends on the number of entries per block: blocks of
+ * 64 entries (8-bit fingerprints) reach a higher load than blocks of 32 (16-bit fingerprints), both stay
+ * below the load of CuckooFilter. For the same load, false positive rate is the same as in CuckooFilter,
+ * because every lookup still compares the fingerprint against 2 * entries_per_bucket entries.
+ * BlockedFilterBenchmark measures both effects.
+ *
+ * Bucket size has to divide the cache line, so (4, 12, uint16_t) buckets are not supported.
+ *
+ * @tparam element_type Working element type
+ * @tparam entries_per_bucket Number of entries in bucket
+ * @tparam bits_per_fp  Number of bits in fingerprint
+ * @tparam fp_type Fingerprint type
+ */
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+class BlockedCuckooFilter {
+
+private:
+    static const size_t bytes_per_bucket = (entries_per_bucket * bits_per_fp) / 8;
+    // number of buckets sharing one cache line
+    static const size_t buckets_per_block = CACHE_LINE_SIZE / bytes_per_bucket;
+
+    static_assert(CACHE_LINE_SIZE % bytes_per_bucket == 0,
+                  "Blocked cuckoo filter requires bucket size which divides the cache line.");
+
+    // mask for extracting lower bits
+    uint32_t fp_mask_;
+
+    // table for storing elements' fingerprints, table memory is aligned to the cache line
+    CuckooTable<entries_per_bucket, bits_per_fp, fp_type> *table_;
+
+    // number of stored elements
+    size_t element_count_;
+
+    // used for calculating hash values
+    HashFunction *hash_function_;
+
+    // fingerprints which did not fit into their block, keyed by block
+    std::unordered_multimap<size_t, Victim> overflow_;
+
+    // flag per block, true if the block has fingerprints in overflow area
+    std::vector<bool> overflowed_blocks_;
+
+    // maximum number of fingerprints in overflow area
+    size_t max_overflow_;
+
+    /**
+     * Gets index from previously calculated hash value.
+     *
+     * @param hash_value Hash value
+     * @return Index out of hash value
+     */
+    inline size_t getIndex(uint32_t hv) const;
+
+    /**
+     * Function for calculating fingerprint out of given hash value.
+     *
+     * @param hash_value Hash value
+     * @return Fingerprint for saving from hash value
+     */
+    inline uint32_t fingerprint(uint32_t hash_value) const;
+
+    /**
+     * Method for calculating first index and fingerprint from element hash value.
+     *
+     * @param item Item to store in filter
+     * @param fp Fingerprint pointer
+     * @param index Index pointer
+     */
+    inline void firstPass(const element_type &item, uint32_t *fp, size_t *index) const;
+
+    /**
+     * Calculating second index inside the block of the previous index
+     *  $i2 = i1 \oplus (hash(f) \bmod (B - 1) + 1)$\;
+     * where B is number of buckets in block. Offset is never 0, so both candidate buckets are
+     * different, and i1 is again obtained from i2 with the same fingerprint.
+     *
+     * @param index Previously calculated index
+     * @param fp Element fingerprint
+     * @return Secondary index from the same block
+     */
+    inline size_t indexComplement(const size_t index, const uint32_t fp) const;
+
+    /**
+     * Checking if any bucket of the block has free entry.
+     *
+     * @param block Block index
+     * @return True if block has at least one free entry
+     */
+    bool hasFreeEntry(size_t block);
+
+    /**
+     * Storing fingerprint to the overflow area and flagging its block.
+     *
+     * @param fp Fingerprint
+     * @param index Bucket index of the fingerprint, either primary or secondary
+     */
+    void stash(uint32_t fp, size_t index);
+
+    /**
+     * Insertion of fingerprint fp on position index, kicking is done only inside the block. Maximum tries
+     * are defined with BLOCKED_KICKS_MAX_COUNT constant, after that the kicked fingerprint goes to the
+     * overflow area. If overflow area is full, the walk is undone and the fingerprint is not inserted.
+     *
+     * @param fp Fingerprint for insertion
+     * @param index Position for insertion
+     * @return True if fingerprint is either in the table or in the overflow area
+     */
+    bool insert(uint32_t fp, size_t index);
+
+public:
+
+    /**
+     * Constructing blocked cuckoo filter with table of at most max_table_size buckets.
+     *
+     * @param max_table_size Maximum table size, it is rounded to power of two not smaller than one block
+     * @param policy Policy of allocating table storage, every policy aligns blocks to cache lines
+     * @param seed Seed of generator choosing evicted entries
+     */
+    BlockedCuckooFilter(uint32_t max_table_size, MemoryPolicy policy = MemoryPolicy::CACHE_ALIGNED,
+                        uint64_t seed = DEFAULT_SEED);
+
+    /**
+     * Destructor that is in charge of memory clean-up.
+     */
+    ~BlockedCuckooFilter();
+
+    /**
+     * Prints cuckoo table with fingerprints of all elements in hexadecimal format.
+     */
+    void print();
+
+    /**
+     * Inserting element into filter. In first pass, fingerprint and index are calculated,
+     * proceeding with insertion with reallocation inside the block.
+     *
+     * @param element Element for insertion
+     * @return True if element is inserted, false if its block and the overflow area are full
+     */
+    bool insertElement(element_type &element);
+
+    /**
+     *  Deleting element from filter. Both candidate buckets are checked,
+     *  if any of them contain fingerprint, it is removed from structure.
+     *
+     * @param element Element for deletion
+     * @return True if item is deleted
+     */
+    bool deleteElement(const element_type &element);
+
+    /**
+     *  Checking if element is contained in filter. Both candidate buckets lie in the same cache line.
+     *
+     * @param element Element for checking
+     * @return True if item is contained
+     */
+    bool containsElement(element_type &element);
+
+    /**
+     * Calculates the percentage of free space in the table that the filter uses.
+     *
+     * @return percentage of free space in the filter's table
+     */
+    double availability();
+
+    /**
+     * Retrieves number of fingerprints stored in the overflow area.
+     *
+     * @return number of overflowed fingerprints
+     */
+    size_t getOverflowSize();
+
+    /**
+     * Retrieves total number of buckets in the table.
+     * @return table size
+     */
+    size_t getTableSize();
+};
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+BlockedCuckooFilter(uint32_t max_table_size, MemoryPolicy policy, uint64_t seed) {
+    element_count_ = 0;
+    this->fp_mask_ = (1ULL << bits_per_fp) - 1;
+    size_t table_size = std::max(highestPowerOfTwo(max_table_size), buckets_per_block);
+
+    table_ = new CuckooTable<entries_per_bucket, bits_per_fp, fp_type>(table_size, fp_mask_, policy, seed);
+    hash_function_ = new HashFunction();
+
+    overflowed_blocks_.assign(table_size / buckets_per_block, false);
+    max_overflow_ = table_size * entries_per_bucket / BLOCKED_OVERFLOW_RATIO;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+getIndex(uint32_t hash_value) const {
+    // equivalent to modulo when number of buckets is a power of two
+    return hash_value & (table_->getTableSize() - 1);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+uint32_t BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+fingerprint(uint32_t hash_value) const {
+    uint32_t fingerprint = hash_value & fp_mask_;
+    // make sure that fingerprint != 0
+    fingerprint += (fingerprint == 0);
+    return fingerprint;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline void BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+firstPass(const element_type &item, uint32_t *fp, size_t *index) const {
+    const uint64_t hash_value = hash_function_->hash(item);
+    *index = getIndex(hash_value >> 32);
+    *fp = fingerprint(hash_value);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+indexComplement(const size_t index, const uint32_t fp) const {
+    uint32_t offset = fingerprintComplement(0, fp) % (buckets_per_block - 1) + 1;
+    return index ^ offset;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+hasFreeEntry(const size_t block) {
+    size_t first = block * buckets_per_block;
+    for (size_t i = first; i < first + buckets_per_block; i++) {
+        if (table_->fingerprintCount(i) < entries_per_bucket) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+stash(const uint32_t fp, const size_t index) {
+    Victim victim;
+    victim.fp = fp;
+    victim.index = index;
+    overflow_.insert(std::make_pair(index / buckets_per_block, victim));
+    overflowed_blocks_[index / buckets_per_block] = true;
+    this->element_count_++;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+insert(uint32_t fp, size_t index) {
+
+    size_t curr_index = index;
+    uint32_t curr_fp = fp;
+    uint32_t prev_fp;
+    // buckets of the walk and fingerprints kicked out of them, so that the walk can be undone
+    size_t path_index[BLOCKED_KICKS_MAX_COUNT];
+    uint32_t path_fp[BLOCKED_KICKS_MAX_COUNT];
+
+    for (int kicks = 0; kicks < BLOCKED_KICKS_MAX_COUNT; kicks++) {
+        bool eject = (kicks != 0);
+        prev_fp = 0;
+        if (table_->replacingFingerprintInsertion(curr_index, curr_fp, eject, prev_fp)) {
+            this->element_count_++;
+            return true;
+        }
+        if (eject) {
+            path_index[kicks] = curr_index;
+            path_fp[kicks] = prev_fp;
+            curr_fp = prev_fp;
+        }
+        curr_index = indexComplement(curr_index, curr_fp);
+    }
+
+    if (overflow_.size() >= max_overflow_) {
+        // every kicked fingerprint is put back in reverse order, the table is left as before the insertion
+        for (int kicks = BLOCKED_KICKS_MAX_COUNT - 1; kicks > 0; kicks--) {
+            uint32_t inserted = kicks > 1 ? path_fp[kicks - 1] : fp;
+            table_->deleteFingerprint(inserted, path_index[kicks]);
+            table_->replacingFingerprintInsertion(path_index[kicks], path_fp[kicks], false, prev_fp);
+        }
+        return false;
+    }
+
+    // free entry of the block was not reached, kicked fingerprint is moved to overflow area
+    stash(curr_fp, curr_index);
+    return true;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+insertElement(element_type &element) {
+    size_t index;
+    uint32_t fp;
+
+    firstPass(element, &fp, &index);
+
+    if (hasFreeEntry(index / buckets_per_block)) {
+        return this->insert(fp, index);
+    }
+
+    // kicking can not help when the whole block is full
+    if (overflow_.size() >= max_overflow_) {
+        return false;
+    }
+    stash(fp, index);
+    return true;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+deleteElement(const element_type &element) {
+    uint32_t fp;
+    size_t i1, i2;
+
+    firstPass(element, &fp, &i1);
+    i2 = indexComplement(i1, fp);
+    size_t block = i1 / buckets_per_block;
+
+    if (table_->deleteFingerprint(fp, i1) || table_->deleteFingerprint(fp, i2)) {
+        this->element_count_--;
+
+        if (overflowed_blocks_[block]) {
+            // freed entry is reused by one of the overflowed fingerprints of the same block
+            auto it = overflow_.find(block);
+            Victim victim = it->second;
+            overflow_.erase(it);
+            overflowed_blocks_[block] = overflow_.count(block) > 0;
+            this->element_count_--;
+            this->insert(victim.fp, victim.index);
+        }
+        return true;
+    }
+
+    if (!overflowed_blocks_[block]) {
+        return false;
+    }
+
+    auto range = overflow_.equal_range(block);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.fp == fp && (it->second.index == i1 || it->second.index == i2)) {
+            overflow_.erase(it);
+            overflowed_blocks_[block] = overflow_.count(block) > 0;
+            this->element_count_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+containsElement(element_type &element) {
+    uint32_t fp;
+    size_t i1, i2;
+
+    firstPass(element, &fp, &i1);
+    i2 = indexComplement(i1, fp);
+
+    if (table_->containsFingerprint(i1, i2, fp)) {
+        return true;
+    }
+
+    size_t block = i1 / buckets_per_block;
+    if (overflow_.empty() || !overflowed_blocks_[block]) {
+        return false;
+    }
+
+    auto range = overflow_.equal_range(block);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.fp == fp && (it->second.index == i1 || it->second.index == i2)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::getOverflowSize() {
+    return overflow_.size();
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::print() {
+    table_->printTable();
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::~BlockedCuckooFilter() {
+    delete table_;
+    delete hash_function_;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+double BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::availability() {
+    size_t free = this->table_->getNumOfFreeEntries();
+    size_t ts = this->table_->maxNoOfElements();
+    return (free / ((double) ts)) * 100.;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t BlockedCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::getTableSize() {
+    return this->table_->getTableSize();
+}
+
+#endif
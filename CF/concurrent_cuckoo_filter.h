@@ -0,0 +1,539 @@
+#ifndef CUCKOOFILTER_CONCURRENT_CUCKOO_FILTER_H
+#define CUCKOOFILTER_CONCURRENT_CUCKOO_FILTER_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include "cuckoo_table.h"
+#include "../Utils/hash_function.h"
+#include "../Utils/util.h"
+
+// maximal number of lock stripes, every stripe guards buckets with equal lower bits of index
+#define LOCK_STRIPES 4096
+// maximal number of buckets visited by breadth-first search for eviction path
+#define CONCURRENT_BFS_MAX_NODES 2048
+// number of path searches of one insertion, paths can be invalidated by concurrent writers
+#define CONCURRENT_MAX_RETRIES 16
+// number of busy-wait iterations before spinning thread yields, lock holder may be descheduled
+#define SPINS_BEFORE_YIELD 64
+
+
+/**
+ * Waiting step of thread spinning on a lock. Processor is hinted to pause, after SPINS_BEFORE_YIELD
+ * steps thread yields, so that it does not burn its time slice when lock holder is not running.
+ *
+ * @param spins Number of preceding waiting steps, incremented
+ */
+static inline void cpuRelax(unsigned &spins) {
+    if (++spins < SPINS_BEFORE_YIELD) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    } else {
+        spins = 0;
+        std::this_thread::yield();
+    }
+}
+
+
+/**
+ * Cuckoo filter which can be shared by threads. Buckets are guarded by striped locks, every stripe holds
+ * version counter which is odd while stripe is locked and incremented on every unlock.
+ *
+ * Lookups do not take locks: they read versions of both stripes, probe buckets and retry if any version
+ * changed meanwhile. Insertions and deletions lock stripes of both candidate buckets, always in increasing
+ * order of stripe index. When both buckets are full, eviction path is found by breadth-first search without
+ * locks and fingerprints are moved backwards from the free entry, every move under locks of its two buckets
+ * after checking that the path is still valid. Fingerprint is copied to its alternative bucket before it is
+ * removed, so it is never missing for concurrent lookups. Evictions are serialized by one mutex, insertions
+ * into free entries, deletions and lookups run in parallel.
+ *
+ * Unlike CuckooFilter there is no victim: insertion returns false when no eviction path is found.
+ *
+ * @tparam element_type Working element type
+ * @tparam entries_per_bucket Number of entries in bucket
+ * @tparam bits_per_fp  Number of bits in fingerprint
+ * @tparam fp_type Fingerprint type
+ */
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+class ConcurrentCuckooFilter {
+
+private:
+    /**
+     * Lock stripe, aligned to cache line so that stripes do not share lines.
+     */
+    struct alignas(CACHE_LINE_SIZE) Stripe {
+        std::atomic<uint32_t> version{0};
+    };
+
+    /**
+     * Bucket visited by breadth-first search. Fingerprint in entry slot of parent bucket
+     * can be moved to this bucket.
+     */
+    struct PathNode {
+        size_t bucket;
+        int32_t parent;
+        uint32_t slot;
+    };
+
+    // mask for extracting lower bits
+    uint32_t fp_mask_;
+
+    // table for storing elements' fingerprints
+    CuckooTable<entries_per_bucket, bits_per_fp, fp_type> *table_;
+
+    // number of stored elements
+    std::atomic<size_t> element_count_;
+
+    // used for calculating hash values
+    HashFunction *hash_function_;
+
+    // lock stripes
+    Stripe *stripes_;
+    // number of stripes minus one, number of stripes is power of two
+    size_t stripe_mask_;
+
+    // serializes evictions
+    std::mutex kick_mutex_;
+
+    // search queue of evictions, guarded by kick_mutex_
+    PathNode *bfs_nodes_;
+
+    inline size_t getIndex(uint32_t hv) const;
+
+    inline uint32_t fingerprint(uint32_t hash_value) const;
+
+    inline void firstPass(const element_type &item, uint32_t *fp, size_t *index) const;
+
+    inline uint32_t indexComplement(size_t index, uint32_t fp) const;
+
+    inline Stripe &stripe(size_t index) const;
+
+    /**
+     * Locks stripe, spinning while it is locked by another thread.
+     *
+     * @param s Stripe
+     */
+    inline void lock(Stripe &s);
+
+    /**
+     * Unlocks stripe and publishes new version.
+     *
+     * @param s Stripe
+     */
+    inline void unlock(Stripe &s);
+
+    /**
+     * Locks stripes of buckets i1 and i2 in increasing order of stripe index.
+     *
+     * @param i1 First bucket index
+     * @param i2 Second bucket index
+     */
+    inline void lockPair(size_t i1, size_t i2);
+
+    /**
+     * Unlocks stripes of buckets i1 and i2.
+     *
+     * @param i1 First bucket index
+     * @param i2 Second bucket index
+     */
+    inline void unlockPair(size_t i1, size_t i2);
+
+    /**
+     * Waits until stripe is unlocked and returns its version for optimistic read.
+     *
+     * @param s Stripe
+     * @return Version of stripe before read
+     */
+    inline uint32_t readBegin(const Stripe &s) const;
+
+    /**
+     * Checks that stripe was not modified since readBegin.
+     *
+     * @param s Stripe
+     * @param version Version returned by readBegin
+     * @return True if optimistic read is valid
+     */
+    inline bool readValidate(const Stripe &s, uint32_t version) const;
+
+    /**
+     * Inserting fingerprint into free entry of bucket i1 or i2 under locks of both buckets.
+     *
+     * @param i1 First bucket index
+     * @param i2 Second bucket index
+     * @param fp Fingerprint for insertion
+     * @return True if fingerprint is inserted
+     */
+    bool insertIntoFree(size_t i1, size_t i2, uint32_t fp);
+
+    /**
+     * Breadth-first search of eviction path from buckets i1 and i2 to bucket with free entry.
+     * Table is read without locks, path has to be validated while moving.
+     *
+     * @param i1 First bucket index
+     * @param i2 Second bucket index
+     * @return Index of node with free entry in search queue, -1 if no path is found
+     */
+    int32_t searchPath(size_t i1, size_t i2);
+
+    /**
+     * Moving fingerprints along the path backwards from the free entry, so that the first bucket
+     * of the path gets a free entry.
+     *
+     * @param found Index of the last node of the path in search queue
+     * @return True if all moves are done, false if path was invalidated by concurrent writer
+     */
+    bool executePath(int32_t found);
+
+    inline bool onPath(int32_t node, size_t bucket) const;
+
+public:
+
+    /**
+     * Constructing concurrent cuckoo filter with table of at most max_table_size buckets.
+     *
+     * @param max_table_size Maximum table size
+     * @param policy Policy of allocating table storage
+     */
+    ConcurrentCuckooFilter(uint32_t max_table_size, MemoryPolicy policy = MemoryPolicy::CACHE_ALIGNED);
+
+    /**
+     * Destructor that is in charge of memory clean-up.
+     */
+    ~ConcurrentCuckooFilter();
+
+    /**
+     * Inserting element into filter, can be called concurrently.
+     *
+     * @param element Element for insertion
+     * @return True if element is inserted, false if filter is full
+     */
+    bool insertElement(const element_type &element);
+
+    /**
+     * Deleting element from filter, can be called concurrently.
+     *
+     * @param element Element for deletion
+     * @return True if item is deleted
+     */
+    bool deleteElement(const element_type &element);
+
+    /**
+     * Checking if element is contained in filter without taking locks, can be called concurrently.
+     *
+     * @param element Element for checking
+     * @return True if item is contained
+     */
+    bool containsElement(const element_type &element);
+
+    /**
+     * Retrieves number of stored elements.
+     * @return number of elements
+     */
+    size_t getElementCount() const;
+
+    /**
+     * Retrieves total number of buckets in the table.
+     * @return table size
+     */
+    size_t getTableSize();
+};
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+ConcurrentCuckooFilter(uint32_t max_table_size, MemoryPolicy policy) : element_count_(0) {
+    this->fp_mask_ = (1ULL << bits_per_fp) - 1;
+    size_t table_size = highestPowerOfTwo(max_table_size);
+
+    table_ = new CuckooTable<entries_per_bucket, bits_per_fp, fp_type>(table_size, fp_mask_, policy);
+    hash_function_ = new HashFunction();
+
+    size_t stripe_count = std::min(table_size, (size_t) LOCK_STRIPES);
+    stripes_ = new Stripe[stripe_count];
+    stripe_mask_ = stripe_count - 1;
+    bfs_nodes_ = new PathNode[CONCURRENT_BFS_MAX_NODES];
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::~ConcurrentCuckooFilter() {
+    delete table_;
+    delete hash_function_;
+    delete[] stripes_;
+    delete[] bfs_nodes_;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+getIndex(uint32_t hash_value) const {
+    // equivalent to modulo when number of buckets is a power of two
+    return hash_value & (table_->getTableSize() - 1);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+uint32_t ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+fingerprint(uint32_t hash_value) const {
+    uint32_t fingerprint = hash_value & fp_mask_;
+    // make sure that fingerprint != 0
+    fingerprint += (fingerprint == 0);
+    return fingerprint;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+firstPass(const element_type &item, uint32_t *fp, size_t *index) const {
+    const uint64_t hash_value = hash_function_->hash(item);
+    *index = getIndex(hash_value >> 32);
+    *fp = fingerprint(hash_value);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+uint32_t ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+indexComplement(const size_t index, const uint32_t fp) const {
+    uint32_t hv = fingerprintComplement(index, fp);
+    return getIndex(hv);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+typename ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::Stripe &
+ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::stripe(const size_t index) const {
+    return stripes_[index & stripe_mask_];
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::lock(Stripe &s) {
+    unsigned spins = 0;
+    while (true) {
+        uint32_t version = s.version.load(std::memory_order_relaxed);
+        if (!(version & 1) &&
+            s.version.compare_exchange_weak(version, version + 1, std::memory_order_acquire)) {
+            return;
+        }
+        cpuRelax(spins);
+    }
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::unlock(Stripe &s) {
+    s.version.fetch_add(1, std::memory_order_release);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+lockPair(const size_t i1, const size_t i2) {
+    size_t s1 = i1 & stripe_mask_, s2 = i2 & stripe_mask_;
+    if (s1 > s2) std::swap(s1, s2);
+    lock(stripes_[s1]);
+    if (s2 != s1) lock(stripes_[s2]);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+unlockPair(const size_t i1, const size_t i2) {
+    size_t s1 = i1 & stripe_mask_, s2 = i2 & stripe_mask_;
+    unlock(stripes_[s1]);
+    if (s2 != s1) unlock(stripes_[s2]);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+uint32_t ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+readBegin(const Stripe &s) const {
+    uint32_t version;
+    unsigned spins = 0;
+    while ((version = s.version.load(std::memory_order_acquire)) & 1) {
+        cpuRelax(spins);
+    }
+    return version;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+readValidate(const Stripe &s, const uint32_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s.version.load(std::memory_order_relaxed) == version;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+insertIntoFree(const size_t i1, const size_t i2, const uint32_t fp) {
+    uint32_t prev_fp = 0;
+    lockPair(i1, i2);
+    bool inserted = table_->replacingFingerprintInsertion(i1, fp, false, prev_fp) ||
+                    table_->replacingFingerprintInsertion(i2, fp, false, prev_fp);
+    unlockPair(i1, i2);
+    if (inserted) {
+        element_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return inserted;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+onPath(int32_t node, const size_t bucket) const {
+    for (; node >= 0; node = bfs_nodes_[node].parent) {
+        if (bfs_nodes_[node].bucket == bucket) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+int32_t ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+searchPath(const size_t i1, const size_t i2) {
+    PathNode *nodes = bfs_nodes_;
+    nodes[0] = {i1, -1, 0};
+    nodes[1] = {i2, -1, 0};
+    int32_t head = 0, tail = 2;
+
+    while (head < tail) {
+        const size_t bucket = nodes[head].bucket;
+        size_t alts[entries_per_bucket];
+        for (size_t j = 0; j < entries_per_bucket; j++) {
+            alts[j] = indexComplement(bucket, table_->getFingerprint(bucket, j));
+            table_->prefetchBucket(alts[j]);
+        }
+
+        for (size_t j = 0; j < entries_per_bucket && tail < CONCURRENT_BFS_MAX_NODES; j++) {
+            if (onPath(head, alts[j])) {
+                continue;
+            }
+            nodes[tail] = {alts[j], head, (uint32_t) j};
+            if (table_->fingerprintCount(alts[j]) < entries_per_bucket) {
+                return tail;
+            }
+            tail++;
+        }
+        head++;
+    }
+    return -1;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+executePath(const int32_t found) {
+    PathNode *nodes = bfs_nodes_;
+    uint32_t prev_fp = 0;
+
+    for (int32_t node = found; nodes[node].parent >= 0; node = nodes[node].parent) {
+        const PathNode &curr = nodes[node];
+        const size_t from = nodes[curr.parent].bucket;
+
+        lockPair(from, curr.bucket);
+        uint32_t moved = table_->getFingerprint(from, curr.slot);
+        if (moved == 0) {
+            // entry was freed by concurrent deletion
+            unlockPair(from, curr.bucket);
+            continue;
+        }
+        if (indexComplement(from, moved) != curr.bucket ||
+            !table_->replacingFingerprintInsertion(curr.bucket, moved, false, prev_fp)) {
+            unlockPair(from, curr.bucket);
+            return false;
+        }
+        // fingerprint is already in its alternative bucket when removed
+        table_->insertFingerprint(from, curr.slot, 0);
+        unlockPair(from, curr.bucket);
+    }
+    return true;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+insertElement(const element_type &element) {
+    uint32_t fp;
+    size_t i1;
+    firstPass(element, &fp, &i1);
+    size_t i2 = indexComplement(i1, fp);
+
+    if (insertIntoFree(i1, i2, fp)) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> guard(kick_mutex_);
+    for (int attempt = 0; attempt < CONCURRENT_MAX_RETRIES; attempt++) {
+        // entry could be freed while waiting for mutex, or freed entry taken by another writer
+        if (insertIntoFree(i1, i2, fp)) {
+            return true;
+        }
+        int32_t found = searchPath(i1, i2);
+        if (found < 0) {
+            return false;
+        }
+        // invalidated path is searched again, moves done before invalidation are valid on their own
+        executePath(found);
+    }
+    return insertIntoFree(i1, i2, fp);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+deleteElement(const element_type &element) {
+    uint32_t fp;
+    size_t i1;
+    firstPass(element, &fp, &i1);
+    size_t i2 = indexComplement(i1, fp);
+
+    lockPair(i1, i2);
+    bool deleted = table_->deleteFingerprint(fp, i1) || table_->deleteFingerprint(fp, i2);
+    unlockPair(i1, i2);
+
+    if (deleted) {
+        element_count_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return deleted;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+containsElement(const element_type &element) {
+    uint32_t fp;
+    size_t i1;
+    firstPass(element, &fp, &i1);
+    size_t i2 = indexComplement(i1, fp);
+
+    const Stripe &s1 = stripe(i1);
+    const Stripe &s2 = stripe(i2);
+    while (true) {
+        uint32_t v1 = readBegin(s1);
+        uint32_t v2 = readBegin(s2);
+        bool found = table_->containsFingerprint(i1, i2, fp);
+        if (readValidate(s1, v1) && readValidate(s2, v2)) {
+            return found;
+        }
+    }
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::getElementCount() const {
+    return element_count_.load(std::memory_order_relaxed);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::getTableSize() {
+    return this->table_->getTableSize();
+}
+
+#endif
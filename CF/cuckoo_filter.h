@@ -1,9 +1,38 @@
+#ifndef CUCKOOFILTER_CUCKOO_FILTER_H
+#define CUCKOOFILTER_CUCKOO_FILTER_H
+
+#include <stdio.h>
 #include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "cuckoo_table.h"
+#include "../Utils/filter_file.h"
 #include "../Utils/hash_function.h"
 #include "../Utils/util.h"
 
 #define KICKS_MAX_COUNT 500
+#define LOOKUP_BATCH_SIZE 64
+// maximal number of buckets visited by breadth-first search for eviction path
+#define BFS_MAX_NODES 2048
+// bulk load sorts elements only by groups of 2^BULK_GROUP_BITS buckets, which stay in cache while filled
+#define BULK_GROUP_BITS 6
+
+/**
+ * Strategy of finding a free entry when both candidate buckets are full.
+ */
+enum class InsertionStrategy {
+    // fingerprints are kicked out of randomly chosen entries, at most KICKS_MAX_COUNT times
+    RANDOM_WALK,
+    // bounded breadth-first search finds the shortest eviction path, fingerprints are moved only after
+    // a free entry is found
+    BFS
+};
 
 
 /**
@@ -38,6 +67,36 @@ private:
     // helper structure
     Victim victim_;
 
+    // copy of victim published to concurrent readers in seqlock mode, version is odd while it is written
+    std::atomic<uint32_t> victim_version_{0};
+    std::atomic<uint32_t> victim_fp_{0};
+    std::atomic<size_t> victim_index_{0};
+
+    // strategy used when candidate buckets are full
+    InsertionStrategy strategy_;
+
+    // bits of bucket index taken from hash, i.e. log2 of table size before any growth
+    unsigned index_bits_;
+
+    // number of times table was doubled by grow, bucket index is extended by this many highest fingerprint bits
+    unsigned growth_count_;
+
+    // seed of generator choosing evicted entries, passed to tables created by grow
+    uint64_t seed_;
+
+    /**
+     * Bucket visited by breadth-first search. Fingerprint in entry slot of parent bucket
+     * can be moved to this bucket.
+     */
+    struct PathNode {
+        size_t bucket;
+        int32_t parent;
+        uint32_t slot;
+    };
+
+    // search queue of breadth-first insertion, allocated for BFS strategy or by bulk load
+    PathNode *bfs_nodes_ = nullptr;
+
     /**
      * Gets index from previously calculated hash value.
      *
@@ -67,12 +126,14 @@ private:
     /**
      * Calculating second index from previous index and calculated fingerprint
      *  $i2 = i1 \oplus hash(f)$\;
+     * Only index bits taken from hash are changed, bits added by grow are the same in both buckets.
+     * Hash of fingerprint depends only on its lowest bits, which are not used by growth.
      *
      * @param index Previously calculated index
      * @param fp Element fingerprint
      * @return Secondary index calculated from fingerprint and previous index
      */
-    inline uint32_t indexComplement(const size_t index, const uint32_t fp) const;
+    inline size_t indexComplement(const size_t index, const uint32_t fp) const;
 
     /**
      * Insertion of fingerprint fp on position index. Maximum tries are defined with KICKS_MAX_COUNT
@@ -84,6 +145,72 @@ private:
      */
     bool insert(uint32_t fp, size_t index);
 
+    /**
+     * Insertion of fingerprint fp with random-walk eviction.
+     *
+     * @param fp Fingerprint for insertion
+     * @param index Position for insertion
+     * @return True if element is inserted, false otherwise, or if item is kicked
+     */
+    bool insertRandomWalk(uint32_t fp, size_t index);
+
+    /**
+     * Insertion of fingerprint fp with breadth-first search of the shortest eviction path. Search visits
+     * at most BFS_MAX_NODES buckets and does not modify the table, fingerprints on the path are moved
+     * backwards from the free entry. If no path is found, fingerprint becomes victim.
+     *
+     * @param fp Fingerprint for insertion
+     * @param index Position for insertion
+     * @return True if element is inserted, or if item is kicked
+     */
+    bool insertBFS(uint32_t fp, size_t index);
+
+    /**
+     * Setting victim, in seqlock mode it is also published to concurrent readers.
+     *
+     * @param index Bucket of victim
+     * @param fp Fingerprint of victim, 0 if there is no victim
+     */
+    inline void setVictim(size_t index, uint32_t fp);
+
+    /**
+     * Reading consistent copy of victim, readers in seqlock mode take the published one.
+     *
+     * @return Victim
+     */
+    inline Victim loadVictim() const;
+
+    /**
+     * Inserting victim into the table at given bucket. Victim stays visible to readers until its fingerprint
+     * is stored and it is cleared only then, it is replaced by kicked fingerprint if insertion fails.
+     *
+     * @param index Bucket of victim, one of its two candidate buckets
+     */
+    void reinsertVictim(size_t index);
+
+    /**
+     * Checks if bucket appears on the search path leading to given node, so that path never
+     * moves fingerprints through the same bucket twice.
+     *
+     * @param node Index of node in search queue
+     * @param bucket Bucket index
+     * @return True if bucket is on the path
+     */
+    inline bool onPath(int32_t node, size_t bucket) const;
+
+    /**
+     * Constructing filter over table loaded from file.
+     *
+     * @param header Header of the file
+     * @param table Loaded table, filter takes ownership
+     */
+    CuckooFilter(const FilterFileHeader &header, CuckooTable<entries_per_bucket, bits_per_fp, fp_type> *table);
+
+    /**
+     * Throws std::runtime_error if table is read-only mapping of a file.
+     */
+    inline void checkWritable() const;
+
 public:
 
     /**
@@ -94,8 +221,12 @@ public:
      * of entries per bucket.
      *
      * @param max_table_size Maximum table size
+     * @param policy Policy of allocating table storage, e.g. backing it with huge pages
+     * @param strategy Strategy of eviction when both candidate buckets are full
+     * @param seed Seed of generator choosing evicted entries, filters with equal seeds evict equally
      */
-    CuckooFilter(uint32_t max_table_size);
+    CuckooFilter(uint32_t max_table_size, MemoryPolicy policy = MemoryPolicy::CACHE_ALIGNED,
+                 InsertionStrategy strategy = InsertionStrategy::RANDOM_WALK, uint64_t seed = DEFAULT_SEED);
 
     /**
      * Destructor that is in charge of memory clean-up.
@@ -116,6 +247,25 @@ public:
      */
     bool insertElement(element_type &element);
 
+    /**
+     * Inserting all elements from range [begin, end), intended for building filter at once. All elements
+     * are hashed first and radix-sorted by primary bucket, so table is filled in memory order. Elements
+     * whose primary bucket is full are sorted by alternative bucket and inserted in the second sequential
+     * pass, only the rest goes through eviction, which uses breadth-first search regardless of filter
+     * strategy. Temporary memory takes 16 bytes per element, larger sets can be loaded in several ranges.
+     * Once eviction leaves a victim, remaining elements are not inserted. As elements are inserted in order
+     * of buckets, they are found by hashing the range again and appended to rejected, so that they can be
+     * loaded after grow.
+     *
+     * @tparam iterator Forward iterator over elements, range is walked twice
+     * @param begin First element
+     * @param end Position after the last element
+     * @param rejected If not null, elements which are not inserted are appended to it
+     * @return Number of inserted elements, smaller than size of range if filter got full
+     */
+    template<typename iterator>
+    size_t bulkLoad(iterator begin, iterator end, std::vector<element_type> *rejected = nullptr);
+
     /**
      *  Deleting element from Cuckoo Filter. Algorithm requires checking both primary and secondary index,
      *  if any of them contain fingerprint, it is removed from structure.
@@ -134,6 +284,17 @@ public:
      */
     bool containsElement(element_type &element);
 
+    /**
+     *  Checking if elements are contained in Cuckoo Filter. Elements are processed in batches of
+     *  LOOKUP_BATCH_SIZE: whole batch is hashed first, then both candidate buckets of every element are
+     *  prefetched and only then buckets are probed, so memory accesses of the batch overlap.
+     *
+     * @param elements Elements for checking
+     * @param count Number of elements
+     * @param out Output array of size count, out[k] is true if elements[k] is contained
+     */
+    void containsElements(const element_type *elements, size_t count, bool *out);
+
     /**
      * Calculates the percentage of free space in the table that the filter uses.
      * @tparam element_type
@@ -147,25 +308,118 @@ public:
      * @return table size
      */
     size_t getTableSize();
+
+    /**
+     * Allows lookups from other threads while one thread modifies the filter. Table is switched to seqlock
+     * mode and insertions use BFS strategy, whose moves copy fingerprint to its alternative bucket before
+     * removing it, so lookups of stored elements never miss. Random walk would keep evicted fingerprint
+     * out of the table until it is placed. Victim is published under its own version counter and cleared
+     * only after it was stored in the table. containsElement and containsElements can be called from any
+     * number of threads, all modifications have to be done by one thread. Has to be called before the
+     * filter is shared.
+     */
+    void enableConcurrentReads();
+
+    /**
+     * Retrieves strategy of eviction used by insertions.
+     * @return insertion strategy
+     */
+    InsertionStrategy getInsertionStrategy() const;
+
+    /**
+     * Doubles the table without the original elements. Bucket index of every element is extended by one
+     * more lowest bit, taken from the highest fingerprint bits not used yet, which are stored in the table.
+     * Fingerprints of bucket i are split between buckets 2i and 2i + 1 in one sequential pass without evictions.
+     * Victim is inserted again into the larger table. Each growth makes one fingerprint bit part of the
+     * bucket index, so false positive rate doubles at the same load, at most bits_per_fp - 1 growths are
+     * possible. Filter must not be read concurrently during growth. std::runtime_error is thrown if filter
+     * is mapped read-only or no fingerprint bits are left.
+     */
+    void grow();
+
+    /**
+     * Retrieves number of times the table was doubled by grow.
+     * @return number of growths
+     */
+    size_t getGrowthCount() const;
+
+    /**
+     * Saving filter into file, which consists of versioned header holding template parameters, hash
+     * function parameters, element count and victim, followed by raw bucket array of the table.
+     * Temporary file is renamed over path once written, so a filter may be saved into the file it was loaded
+     * from. std::runtime_error is thrown if file can not be written.
+     *
+     * @param path Path of the file
+     */
+    void save(const std::string &path) const;
+
+    /**
+     * Loading filter saved by save. When mapped, bucket array is memory-mapped read-only and lookups are
+     * served directly from the mapping without copying, pages are read on first access. Mapped filter
+     * can not be modified, insertions and deletions throw std::runtime_error. std::runtime_error is also
+     * thrown if file is not a filter saved with the same template parameters.
+     *
+     * @param path Path of the file
+     * @param mapped True to map bucket array instead of reading it into memory
+     * @return Loaded filter, owned by caller
+     */
+    static CuckooFilter *load(const std::string &path, bool mapped = false);
 };
 
 
 
 template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
-CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::CuckooFilter(uint32_t max_table_size) {
+CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+CuckooFilter(uint32_t max_table_size, MemoryPolicy policy, InsertionStrategy strategy, uint64_t seed) {
     element_count_ = 0;
+    strategy_ = strategy;
     this->fp_mask_ = (1ULL << bits_per_fp) - 1;
     size_t table_size = highestPowerOfTwo(max_table_size);
+    index_bits_ = __builtin_ctzll(table_size);
+    growth_count_ = 0;
+    seed_ = seed;
 
-    table_ = new CuckooTable<entries_per_bucket, bits_per_fp, fp_type>(table_size, fp_mask_);
+    table_ = new CuckooTable<entries_per_bucket, bits_per_fp, fp_type>(table_size, fp_mask_, policy, seed);
     hash_function_ = new HashFunction();
+
+    if (strategy_ == InsertionStrategy::BFS) {
+        bfs_nodes_ = new PathNode[BFS_MAX_NODES];
+    }
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+CuckooFilter(const FilterFileHeader &header, CuckooTable<entries_per_bucket, bits_per_fp, fp_type> *table) {
+    element_count_ = header.element_count;
+    strategy_ = InsertionStrategy::RANDOM_WALK;
+    this->fp_mask_ = (1ULL << bits_per_fp) - 1;
+    table_ = table;
+    growth_count_ = header.growth_count;
+    index_bits_ = __builtin_ctzll(header.table_size) - growth_count_;
+    seed_ = DEFAULT_SEED;
+
+    unsigned __int128 multiply = ((unsigned __int128) header.hash_multiply[1] << 64) | header.hash_multiply[0];
+    unsigned __int128 add = ((unsigned __int128) header.hash_add[1] << 64) | header.hash_add[0];
+    hash_function_ = new HashFunction(multiply, add);
+
+    victim_.index = header.victim_index;
+    victim_.fp = header.victim_fp;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline void CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::checkWritable() const {
+    if (table_->isReadOnly()) {
+        throw std::runtime_error("Filter mapped from file is read-only");
+    }
 }
 
 
 template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 size_t CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::getIndex(uint32_t hash_value) const {
-    // equivalent to modulo when number of buckets is a power of two
-    return hash_value & (table_->getTableSize() - 1);
+    // equivalent to modulo when number of buckets before growth is a power of two
+    return hash_value & ((1ULL << index_bits_) - 1);
 }
 
 
@@ -183,22 +437,34 @@ inline void
 CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
 firstPass(const element_type &item, uint32_t *fp, size_t *index) const {
     const uint64_t hash_value = hash_function_->hash(item);
-    *index = getIndex(hash_value >> 32);
     *fp = fingerprint(hash_value);
+    *index = getIndex(hash_value >> 32) << growth_count_;
+    if (growth_count_ > 0) {
+        *index |= *fp >> (bits_per_fp - growth_count_);
+    }
 }
 
 
 template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
-uint32_t CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+size_t CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
 indexComplement(const size_t index, const uint32_t fp) const {
-    uint32_t hv = fingerprintComplement(index, fp);
-    return getIndex(hv);
+    return index ^ (getIndex(fingerprintComplement(0, fp)) << growth_count_);
 }
 
 
 template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 bool CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
 insert(uint32_t fp, size_t index) {
+    if (strategy_ == InsertionStrategy::BFS) {
+        return insertBFS(fp, index);
+    }
+    return insertRandomWalk(fp, index);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+insertRandomWalk(uint32_t fp, size_t index) {
 
     size_t curr_index = index;
     uint32_t curr_fp = fp;
@@ -217,18 +483,148 @@ insert(uint32_t fp, size_t index) {
         curr_index = indexComplement(curr_index, curr_fp);
     }
 
-    victim_.index = curr_index;
-    victim_.fp = curr_fp;
+    setVictim(curr_index, curr_fp);
     return true;
 }
 
 
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline bool CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+onPath(int32_t node, const size_t bucket) const {
+    for (; node >= 0; node = bfs_nodes_[node].parent) {
+        if (bfs_nodes_[node].bucket == bucket) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+insertBFS(uint32_t fp, size_t index) {
+    uint32_t prev_fp = 0;
+    if (table_->replacingFingerprintInsertion(index, fp, false, prev_fp)) {
+        this->element_count_++;
+        return true;
+    }
+    size_t alt_index = indexComplement(index, fp);
+    if (table_->replacingFingerprintInsertion(alt_index, fp, false, prev_fp)) {
+        this->element_count_++;
+        return true;
+    }
+
+    PathNode *nodes = bfs_nodes_;
+    nodes[0] = {index, -1, 0};
+    nodes[1] = {alt_index, -1, 0};
+    int32_t head = 0, tail = 2;
+    int32_t found = -1;
+
+    // every visited bucket is full, children are buckets where its fingerprints can be moved
+    while (head < tail && found < 0) {
+        const size_t bucket = nodes[head].bucket;
+        size_t alts[entries_per_bucket];
+        for (size_t j = 0; j < entries_per_bucket; j++) {
+            alts[j] = indexComplement(bucket, table_->getFingerprint(bucket, j));
+            table_->prefetchBucket(alts[j]);
+        }
+
+        for (size_t j = 0; j < entries_per_bucket && tail < BFS_MAX_NODES; j++) {
+            if (onPath(head, alts[j])) {
+                continue;
+            }
+            nodes[tail] = {alts[j], head, (uint32_t) j};
+            if (table_->fingerprintCount(alts[j]) < entries_per_bucket) {
+                found = tail;
+                break;
+            }
+            tail++;
+        }
+        head++;
+    }
+
+    if (found < 0) {
+        // table is not modified, element itself is kept aside
+        setVictim(index, fp);
+        return true;
+    }
+
+    // moving fingerprints backwards, every move fills entry freed by the previous one
+    for (int32_t node = found; nodes[node].parent >= 0; node = nodes[node].parent) {
+        const PathNode &curr = nodes[node];
+        const size_t from = nodes[curr.parent].bucket;
+        uint32_t moved = table_->getFingerprint(from, curr.slot);
+        table_->replacingFingerprintInsertion(curr.bucket, moved, false, prev_fp);
+        table_->insertFingerprint(from, curr.slot, 0);
+    }
+
+    int32_t root = found;
+    while (nodes[root].parent >= 0) {
+        root = nodes[root].parent;
+    }
+    table_->replacingFingerprintInsertion(nodes[root].bucket, fp, false, prev_fp);
+    this->element_count_++;
+    return true;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline void CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+setVictim(const size_t index, const uint32_t fp) {
+    victim_.index = index;
+    victim_.fp = fp;
+    if (table_->isSeqlocked()) {
+        uint32_t version = victim_version_.load(std::memory_order_relaxed);
+        victim_version_.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        victim_fp_.store(fp, std::memory_order_relaxed);
+        victim_index_.store(index, std::memory_order_relaxed);
+        victim_version_.store(version + 2, std::memory_order_release);
+    }
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline Victim CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::loadVictim() const {
+    if (!table_->isSeqlocked()) {
+        return victim_;
+    }
+    Victim victim;
+    while (true) {
+        uint32_t version = victim_version_.load(std::memory_order_acquire);
+        if (version & 1) {
+            // writer is in the middle of changing victim
+            continue;
+        }
+        victim.fp = victim_fp_.load(std::memory_order_relaxed);
+        victim.index = victim_index_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (victim_version_.load(std::memory_order_relaxed) == version) {
+            return victim;
+        }
+    }
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::reinsertVictim(const size_t index) {
+    const uint32_t fp = victim_.fp;
+    const size_t count = element_count_;
+    this->insert(fp, index);
+    // failed insertion already replaced victim, by the same fingerprint with BFS or by kicked one with random walk
+    if (element_count_ != count) {
+        setVictim(0, 0);
+    }
+}
+
+
 template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 bool CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
 insertElement(element_type &element) {
     size_t index;
     uint32_t fp;
 
+    checkWritable();
     if (victim_.fp) return false;
 
     firstPass(element, &fp, &index);
@@ -236,12 +632,100 @@ insertElement(element_type &element) {
 }
 
 
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+template<typename iterator>
+size_t CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+bulkLoad(iterator begin, iterator end, std::vector<element_type> *rejected) {
+    static_assert(std::is_base_of<std::forward_iterator_tag,
+                          typename std::iterator_traits<iterator>::iterator_category>::value,
+                  "Range of bulk load is walked twice, forward iterator is required");
+    checkWritable();
+    size_t n = std::distance(begin, end);
+    if (n == 0) return 0;
+    if (victim_.fp) {
+        if (rejected) rejected->insert(rejected->end(), begin, end);
+        return 0;
+    }
+
+    // key is primary index in upper and fingerprint in lower 32 bits
+    uint64_t *keys = new uint64_t[n];
+    uint64_t *tmp = new uint64_t[n];
+    const unsigned index_bits = __builtin_ctzll(table_->getTableSize());
+    const unsigned group_bits = std::min(index_bits, (unsigned) BULK_GROUP_BITS);
+
+    size_t k = 0;
+    for (iterator it = begin; it != end; ++it, k++) {
+        uint32_t fp;
+        size_t index;
+        firstPass(*it, &fp, &index);
+        keys[k] = ((uint64_t) index << 32) | fp;
+    }
+    radixSort(keys, tmp, n, 32 + group_bits, index_bits - group_bits);
+
+    uint32_t prev_fp = 0;
+    size_t overflow = 0;
+    for (k = 0; k < n; k++) {
+        size_t index = keys[k] >> 32;
+        uint32_t fp = (uint32_t) keys[k];
+        if (table_->replacingFingerprintInsertion(index, fp, false, prev_fp)) {
+            this->element_count_++;
+        } else {
+            tmp[overflow++] = ((uint64_t) indexComplement(index, fp) << 32) | fp;
+        }
+    }
+    radixSort(tmp, keys, overflow, 32 + group_bits, index_bits - group_bits);
+
+    size_t remaining = 0;
+    for (k = 0; k < overflow; k++) {
+        size_t index = tmp[k] >> 32;
+        uint32_t fp = (uint32_t) tmp[k];
+        if (table_->replacingFingerprintInsertion(index, fp, false, prev_fp)) {
+            this->element_count_++;
+        } else {
+            keys[remaining++] = tmp[k];
+        }
+    }
+
+    // remaining elements are inserted into almost full table, where path search beats random walk
+    if (remaining > 0 && bfs_nodes_ == nullptr) {
+        bfs_nodes_ = new PathNode[BFS_MAX_NODES];
+    }
+    for (k = 0; k < remaining && !victim_.fp; k++) {
+        this->insertBFS((uint32_t) keys[k], keys[k] >> 32);
+    }
+
+    // keys from k on are not inserted, equal keys of several elements are counted
+    const size_t dropped = remaining - k;
+    if (rejected && dropped > 0) {
+        std::unordered_map<uint64_t, size_t> counts;
+        for (; k < remaining; k++) {
+            counts[keys[k]]++;
+        }
+        for (iterator it = begin; it != end; ++it) {
+            uint32_t fp;
+            size_t index;
+            firstPass(*it, &fp, &index);
+            auto found = counts.find(((uint64_t) indexComplement(index, fp) << 32) | fp);
+            if (found != counts.end() && found->second > 0) {
+                found->second--;
+                rejected->push_back(*it);
+            }
+        }
+    }
+
+    delete[] keys;
+    delete[] tmp;
+    return n - dropped;
+}
+
+
 template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 bool CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
 deleteElement(const element_type &element) {
     uint32_t fp;
     size_t i1, i2;
 
+    checkWritable();
     firstPass(element, &fp, &i1);
 
     if (table_->deleteFingerprint(fp, i1)) {
@@ -253,7 +737,7 @@ deleteElement(const element_type &element) {
         } else if (victim_.fp && fp == victim_.fp &&
                    (i1 == victim_.index || i2 == victim_.index)) {
             // element count remains unmodified, victim is not regarded as a part of the table
-            victim_.fp = 0;
+            setVictim(0, 0);
             return true;
         } else {
             return false;
@@ -261,10 +745,7 @@ deleteElement(const element_type &element) {
     }
 
     if (victim_.fp) {
-        size_t index = victim_.index;
-        uint32_t fp = victim_.fp;
-        victim_.fp = 0;
-        this->insert(fp, index);
+        reinsertVictim(victim_.index);
     }
 
     return true;
@@ -278,6 +759,16 @@ containsElement(element_type &element) {
     size_t i1, i2;
 
     firstPass(element, &fp, &i1);
+    if (table_->isSeqlocked()) {
+        // victim is checked first, it is cleared only after it was stored in the table
+        i2 = indexComplement(i1, fp);
+        Victim victim = loadVictim();
+        if (victim.fp && fp == victim.fp && (i1 == victim.index || i2 == victim.index)) {
+            return true;
+        }
+        // buckets have to be read together, fingerprint can move between them
+        return table_->containsFingerprint(i1, i2, fp);
+    }
     if (table_->containsFingerprint(i1, fp)) {
         return true;
     }
@@ -289,6 +780,36 @@ containsElement(element_type &element) {
 }
 
 
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+containsElements(const element_type *elements, const size_t count, bool *out) {
+    uint32_t fps[LOOKUP_BATCH_SIZE];
+    size_t i1s[LOOKUP_BATCH_SIZE];
+    size_t i2s[LOOKUP_BATCH_SIZE];
+
+    for (size_t start = 0; start < count; start += LOOKUP_BATCH_SIZE) {
+        size_t batch = std::min((size_t) LOOKUP_BATCH_SIZE, count - start);
+
+        for (size_t k = 0; k < batch; k++) {
+            firstPass(elements[start + k], &fps[k], &i1s[k]);
+            i2s[k] = indexComplement(i1s[k], fps[k]);
+            table_->prefetchBucket(i1s[k]);
+            table_->prefetchBucket(i2s[k]);
+        }
+
+        // victim is read before the table, see containsElement
+        Victim victim = loadVictim();
+        table_->containsFingerprints(i1s, i2s, fps, batch, out + start);
+
+        if (victim.fp) {
+            for (size_t k = 0; k < batch; k++) {
+                out[start + k] |= (fps[k] == victim.fp) && (i1s[k] == victim.index || i2s[k] == victim.index);
+            }
+        }
+    }
+}
+
+
 template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 void CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::print() {
     table_->printTable();
@@ -299,6 +820,7 @@ template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, t
 CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::~CuckooFilter() {
     delete table_;
     delete hash_function_;
+    delete[] bfs_nodes_;
 }
 
 
@@ -314,3 +836,129 @@ template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, t
 size_t CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::getTableSize() {
     return this->table_->getTableSize();
 }
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+InsertionStrategy CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::getInsertionStrategy() const {
+    return strategy_;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::grow() {
+    checkWritable();
+    if (growth_count_ + 1 >= bits_per_fp) {
+        throw std::runtime_error("Fingerprint has no bits left for growth of the table");
+    }
+
+    const size_t table_size = table_->getTableSize();
+    CuckooTable<entries_per_bucket, bits_per_fp, fp_type> *grown =
+            new CuckooTable<entries_per_bucket, bits_per_fp, fp_type>(2 * table_size, fp_mask_,
+                                                                      table_->getMemoryPolicy(), seed_);
+    const unsigned fp_bit = bits_per_fp - 1 - growth_count_;
+    table_->splitInto(*grown, fp_bit);
+    if (table_->isSeqlocked()) {
+        grown->enableSeqlock();
+    }
+    delete table_;
+    table_ = grown;
+    growth_count_++;
+
+    if (victim_.fp) {
+        // victim index is one of its buckets, which are split by the same fingerprint bit
+        reinsertVictim(2 * victim_.index + ((victim_.fp >> fp_bit) & 1));
+    }
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::getGrowthCount() const {
+    return growth_count_;
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::enableConcurrentReads() {
+    table_->enableSeqlock();
+    setVictim(victim_.index, victim_.fp);
+    strategy_ = InsertionStrategy::BFS;
+    if (bfs_nodes_ == nullptr) {
+        bfs_nodes_ = new PathNode[BFS_MAX_NODES];
+    }
+}
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::save(const std::string &path) const {
+    FilterFileHeader header;
+    header.entries_per_bucket = entries_per_bucket;
+    header.bits_per_fp = bits_per_fp;
+    header.fp_size = sizeof(fp_type);
+    header.element_size = sizeof(element_type);
+
+    unsigned __int128 multiply = hash_function_->getMultiply();
+    unsigned __int128 add = hash_function_->getAdd();
+    header.hash_multiply[0] = (uint64_t) multiply;
+    header.hash_multiply[1] = (uint64_t) (multiply >> 64);
+    header.hash_add[0] = (uint64_t) add;
+    header.hash_add[1] = (uint64_t) (add >> 64);
+
+    header.table_size = table_->getTableSize();
+    header.element_count = element_count_;
+    header.victim_index = victim_.index;
+    header.victim_fp = victim_.fp;
+    header.bucket_bytes = table_->getBucketBytes();
+    header.growth_count = growth_count_;
+
+    // file is replaced only when completely written, it may be the file this filter is mapped from
+    const std::string temporary = temporaryFilterPath(path);
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Can not open " + path + " for writing");
+    }
+    try {
+        writeFilterHeader(out, header);
+        table_->writeBuckets(out);
+    } catch (...) {
+        remove(temporary.c_str());
+        throw;
+    }
+    commitFilterFile(out, temporary, path);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> *
+CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::load(const std::string &path, bool mapped) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Can not open " + path + " for reading");
+    }
+    FilterFileHeader header = readFilterHeader(in);
+    checkFilterHeader(header, entries_per_bucket, bits_per_fp, sizeof(fp_type), sizeof(element_type));
+    if (header.growth_count >= bits_per_fp || (header.table_size >> header.growth_count) == 0) {
+        throw std::runtime_error("Filter file has inconsistent number of growths");
+    }
+
+    const uint32_t fp_mask = (1ULL << bits_per_fp) - 1;
+    CuckooTable<entries_per_bucket, bits_per_fp, fp_type> *table;
+    if (mapped) {
+        // bucket array is followed by padding of 8 bytes, which table reads past the last bucket
+        MemoryBlock memory = mapFile(path.c_str(), FILTER_FILE_HEADER_SIZE, header.bucket_bytes + sizeof(uint64_t));
+        table = new CuckooTable<entries_per_bucket, bits_per_fp, fp_type>(header.table_size, fp_mask, memory);
+    } else {
+        table = new CuckooTable<entries_per_bucket, bits_per_fp, fp_type>(header.table_size, fp_mask);
+        try {
+            table->readBuckets(in);
+        } catch (...) {
+            delete table;
+            throw;
+        }
+    }
+    if (table->getBucketBytes() != header.bucket_bytes) {
+        delete table;
+        throw std::runtime_error("Filter file has inconsistent table size");
+    }
+    return new CuckooFilter(header, table);
+}
+
+#endif
@@ -1,11 +1,25 @@
+#ifndef CUCKOOFILTER_CUCKOO_TABLE_H
+#define CUCKOOFILTER_CUCKOO_TABLE_H
+
 #include <string.h>
 #include <stdint.h>
 #include <assert.h>
 #include <type_traits>
 #include <exception>
 #include <iomanip>
+#include <atomic>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
 
 #include "../Utils/bit_manager.h"
+#include "../Utils/memory_manager.h"
+#include "../Utils/simd_probe.h"
+#include "../Utils/random.h"
+
+// maximal number of version counters of seqlock mode
+#define SEQLOCK_STRIPES 16384
 
 
 template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
@@ -18,16 +32,87 @@ private:
     // mask for extracting lower bits
     uint32_t fp_mask;
 
-    // manipulation with bits
-    BitManager<fp_type> *bit_manager;
+    // manipulation with bits, resolved at compile time
+    typedef BitManager<entries_per_bucket, bits_per_fp, fp_type> bit_manager;
+
+    // bucket layout can be probed by SIMD kernels
+    static const bool simd_probe = simdProbeSupported(entries_per_bucket, bits_per_fp);
 
     struct Bucket {
         uint8_t data[bytes_per_bucket];
     };
 
+    // memory backing the buckets, aligned to cache line (or huge page)
+    MemoryBlock memory;
+
     // element storage
     Bucket *buckets;
 
+    // generator choosing evicted entries
+    FastRandom rng;
+
+    // version counters of bucket stripes in seqlock mode, nullptr when mode is off
+    std::atomic<uint32_t> *versions = nullptr;
+    // number of version stripes minus one
+    size_t version_mask = 0;
+
+    /**
+     * Probes bucket i without synchronization.
+     */
+    inline bool probeBucket(size_t i, uint32_t fp);
+
+    /**
+     * Probes buckets i1 and i2 without synchronization.
+     */
+    inline bool probePair(size_t i1, size_t i2, uint32_t fp);
+
+    /**
+     * Probes bucket pairs of several elements without synchronization.
+     */
+    inline void probePairs(const size_t *i1, const size_t *i2, const uint32_t *fps, size_t count, bool *out);
+
+    /**
+     * Marks stripe of bucket i as being written, its version becomes odd.
+     *
+     * @param i Bucket index
+     */
+    inline void writeBegin(size_t i);
+
+    /**
+     * Publishes write to stripe of bucket i, its version becomes even again.
+     *
+     * @param i Bucket index
+     */
+    inline void writeEnd(size_t i);
+
+    /**
+     * Waits until stripe of bucket i is not being written and returns its version.
+     *
+     * @param i Bucket index
+     * @return Version of stripe before read
+     */
+    inline uint32_t readBegin(size_t i) const;
+
+    /**
+     * Checks if stripe of bucket i was written since readBegin, so that read has to be repeated.
+     *
+     * @param i Bucket index
+     * @param version Version returned by readBegin
+     * @return True if read is not valid
+     */
+    inline bool readRetry(size_t i, uint32_t version) const;
+
+    /**
+     * Loading 64-bit word starting at bucket i. Buckets are packed, so the word may be unaligned
+     * and contain part of following bucket, storage is padded so that the last bucket can be loaded too.
+     * Buckets of 1, 2 or 4 bytes are loaded alone and zero-extended, so that the last bucket of a cache line
+     * does not touch the next one, which BlockedCuckooFilter relies on.
+     *
+     * @param i Bucket index
+     * @return 64-bit word with bucket i in lowest bytes
+     */
+    inline uint64_t loadBucket(size_t i) const;
+
 public:
 
     /**
@@ -38,11 +123,25 @@ public:
      * @tparam fp_type Fingerprint type
      * @param table_size Table size, total number of buckets
      * @param fp_mask Fingerprint mask from filter
+     * @param policy Policy of allocating bucket storage
+     * @param seed Seed of generator choosing evicted entries
+     */
+    CuckooTable(size_t table_size, uint32_t fp_mask, MemoryPolicy policy = MemoryPolicy::CACHE_ALIGNED,
+                uint64_t seed = DEFAULT_SEED);
+
+    /**
+     * Constructing table over existing bucket storage, e.g. memory-mapped file. Storage has to hold
+     * getBucketBytes() bytes of buckets followed by 8 bytes of padding. Table takes ownership of the block.
+     *
+     * @param table_size Table size, total number of buckets
+     * @param fp_mask Fingerprint mask from filter
+     * @param memory Bucket storage
+     * @param seed Seed of generator choosing evicted entries
      */
-    CuckooTable(size_t table_size, uint32_t fp_mask);
+    CuckooTable(size_t table_size, uint32_t fp_mask, MemoryBlock memory, uint64_t seed = DEFAULT_SEED);
 
     /**
-     * Deleting all entries from cuckoo table and deleting bit manager.
+     * Deleting all entries from cuckoo table.
      */
     ~CuckooTable();
 
@@ -60,6 +159,59 @@ public:
      */
     size_t maxNoOfElements();
 
+    /**
+     * Returning policy used for allocating bucket storage, which can be weaker than requested one
+     * if huge pages are not available.
+     *
+     * @return Memory policy of the table
+     */
+    MemoryPolicy getMemoryPolicy() const;
+
+    /**
+     * Switching table to seqlock mode, in which one writer thread can modify table while other threads
+     * read it. Buckets are divided into at most SEQLOCK_STRIPES stripes with version counter, which writes
+     * of fingerprints increment before and after modifying the bucket. Readers never lock, they repeat the
+     * probe if version changed meanwhile, and wait only while a single fingerprint is being written.
+     * Writer has to move fingerprints copy-first, i.e. insert into new bucket before deleting from the old one.
+     * Mode has to be enabled before table is shared.
+     */
+    void enableSeqlock();
+
+    /**
+     * Returns true if table is in seqlock mode.
+     *
+     * @return True if readers are synchronized with version counters
+     */
+    bool isSeqlocked() const;
+
+    /**
+     * Returns size of bucket array in bytes, without padding.
+     *
+     * @return Size of buckets in bytes
+     */
+    size_t getBucketBytes() const;
+
+    /**
+     * Returns true if buckets are read-only mapping of a file, which can not be modified.
+     *
+     * @return True if table is read-only
+     */
+    bool isReadOnly() const;
+
+    /**
+     * Writing raw bucket array followed by 8 bytes of padding, as expected by mapped table.
+     *
+     * @param out Output stream
+     */
+    void writeBuckets(std::ostream &out) const;
+
+    /**
+     * Reading raw bucket array written by writeBuckets, std::runtime_error is thrown if stream is too short.
+     *
+     * @param in Input stream
+     */
+    void readBuckets(std::istream &in);
+
     /**
      *  Gets fingerprint in bucket i with entry position j
      *
@@ -128,6 +280,26 @@ public:
      */
     bool containsFingerprint(size_t i1, size_t i2, uint32_t fp);
 
+    /**
+     * Checking fingerprints of several elements against their buckets i1 and i2. Buckets are probed by
+     * AVX2 or AVX-512 kernel when the CPU and bucket layout allow it, SWAR probe is used otherwise.
+     *
+     * @param i1 First bucket indices
+     * @param i2 Second bucket indices
+     * @param fps Fingerprints to check
+     * @param count Number of elements
+     * @param out True for element k if it is contained
+     */
+    void containsFingerprints(const size_t *i1, const size_t *i2, const uint32_t *fps, size_t count, bool *out);
+
+    /**
+     * Issues software prefetch of bucket with index i, so that following probe of the same bucket
+     * does not stall on memory.
+     *
+     * @param i Bucket index
+     */
+    void prefetchBucket(size_t i) const;
+
     /**
      * Deleting fingerprint from table. If fingerprint is not presented in certain bucket, returning false.
      *
@@ -136,44 +308,44 @@ public:
      * @return True if element is deleted
      */
     bool deleteFingerprint(uint32_t fp, size_t i);
+
+    /**
+     * Copying fingerprints into table of twice the size. Fingerprint from bucket i goes to bucket 2i or
+     * 2i + 1 according to its bit fp_bit, into the same entry, so no bucket can overflow.
+     *
+     * @param target Empty table with twice as many buckets
+     * @param fp_bit Bit of fingerprint selecting the half of target table
+     */
+    void splitInto(CuckooTable &target, unsigned fp_bit);
 };
 
 
 template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
-CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::CuckooTable(const size_t table_size, uint32_t fp_mask) {
+CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::CuckooTable(const size_t table_size, uint32_t fp_mask,
+                                                                   MemoryPolicy policy, uint64_t seed) : rng(seed) {
     this->table_size = table_size;
     this->fp_mask = fp_mask;
 
-    buckets = new Bucket[table_size];
-    memset(buckets, 0, bytes_per_bucket * table_size);
-
-    if (entries_per_bucket == 4 && bits_per_fp == 4 && std::is_same<fp_type, uint8_t>::value) {
-        bit_manager = new BitManager4<fp_type>();
-    } else if (entries_per_bucket == 4 && bits_per_fp == 8 && std::is_same<fp_type, uint8_t>::value) {
-        bit_manager = new BitManager8<fp_type>();
-    } else if (entries_per_bucket == 4 && bits_per_fp == 12 && std::is_same<fp_type, uint16_t>::value) {
-        bit_manager = new BitManager12<fp_type>();
-    } else if (entries_per_bucket == 4 && bits_per_fp == 16 && std::is_same<fp_type, uint16_t>::value) {
-        bit_manager = new BitManager16<fp_type>();
-    } else if (entries_per_bucket == 2 && bits_per_fp == 32 && std::is_same<fp_type, uint32_t>::value) {
-        bit_manager = new BitManager32<fp_type>();
-    } else {
-        throw std::runtime_error("Invalid parameters.\n"
-                                 "Supported parameter values for (entries_per_bucket, bits_per_fp, fp_type):\n"
-                                 "{(4,  4, uint8_t),\n"
-                                 " (4,  8, uint8_t),\n"
-                                 " (4, 12, uint16_t),\n"
-                                 " (4, 16, uint16_t),\n"
-                                 " (2, 32, uint32_t)}\n");
-    }
+    // padding for 64-bit load of the last bucket, memory is zeroed by memory manager
+    memory = allocateMemory(bytes_per_bucket * table_size + sizeof(uint64_t), policy);
+    buckets = (Bucket *) memory.data;
+}
+
 
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::CuckooTable(const size_t table_size, uint32_t fp_mask,
+                                                                   MemoryBlock memory, uint64_t seed) : rng(seed) {
+    this->table_size = table_size;
+    this->fp_mask = fp_mask;
+    this->memory = memory;
+    buckets = (Bucket *) memory.data;
 }
 
 
 template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::~CuckooTable() {
-    delete[] buckets;
-    delete bit_manager;
+    releaseMemory(memory);
+    delete[] versions;
 }
 
 
@@ -189,11 +361,117 @@ size_t CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::maxNoOfElements()
 }
 
 
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+MemoryPolicy CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::getMemoryPolicy() const {
+    return memory.policy;
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::enableSeqlock() {
+    if (versions) return;
+    size_t stripes = std::min(table_size, (size_t) SEQLOCK_STRIPES);
+    versions = new std::atomic<uint32_t>[stripes];
+    for (size_t s = 0; s < stripes; s++) {
+        versions[s].store(0, std::memory_order_relaxed);
+    }
+    version_mask = stripes - 1;
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::isSeqlocked() const {
+    return versions != nullptr;
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::getBucketBytes() const {
+    return bytes_per_bucket * table_size;
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::isReadOnly() const {
+    return memory.policy == MemoryPolicy::MAPPED_FILE;
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::writeBuckets(std::ostream &out) const {
+    const uint64_t padding = 0;
+    out.write((const char *) memory.data, getBucketBytes());
+    out.write((const char *) &padding, sizeof(padding));
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::readBuckets(std::istream &in) {
+    in.read((char *) memory.data, getBucketBytes());
+    if (!in) {
+        throw std::runtime_error("File is too short for filter table");
+    }
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::writeBegin(const size_t i) {
+    std::atomic<uint32_t> &version = versions[i & version_mask];
+    version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::writeEnd(const size_t i) {
+    std::atomic<uint32_t> &version = versions[i & version_mask];
+    version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline uint32_t CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::readBegin(const size_t i) const {
+    const std::atomic<uint32_t> &version = versions[i & version_mask];
+    uint32_t v;
+    while ((v = version.load(std::memory_order_acquire)) & 1) {
+        // writer is in the middle of a single fingerprint write
+    }
+    return v;
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline bool CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::readRetry(const size_t i, const uint32_t v) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return versions[i & version_mask].load(std::memory_order_relaxed) != v;
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline uint64_t CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::loadBucket(const size_t i) const {
+    if constexpr (bytes_per_bucket == sizeof(uint8_t)) {
+        return buckets[i].data[0];
+    } else if constexpr (bytes_per_bucket == sizeof(uint16_t)) {
+        uint16_t val;
+        memcpy(&val, buckets[i].data, sizeof(val));
+        return val;
+    } else if constexpr (bytes_per_bucket == sizeof(uint32_t)) {
+        uint32_t val;
+        memcpy(&val, buckets[i].data, sizeof(val));
+        return val;
+    } else {
+        uint64_t val;
+        memcpy(&val, buckets[i].data, sizeof(val));
+        return val;
+    }
+}
+
+
 template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 inline uint32_t CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::
 getFingerprint(const size_t i, const size_t j) {
     const uint8_t *bucket = buckets[i].data;
-    uint32_t fp = bit_manager->read(j, bucket);
+    uint32_t fp = bit_manager::read(j, bucket);
     return fp & fp_mask;
 }
 
@@ -216,7 +494,13 @@ void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::
 insertFingerprint(const size_t i, const size_t j, const uint32_t fp) {
     const uint8_t *bucket = buckets[i].data;
     uint32_t efp = fp & fp_mask;
-    bit_manager->write(j, bucket, efp);
+    if (versions) {
+        writeBegin(i);
+        bit_manager::write(j, bucket, efp);
+        writeEnd(i);
+        return;
+    }
+    bit_manager::write(j, bucket, efp);
 }
 
 
@@ -233,7 +517,7 @@ CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::replacingFingerprintInser
     }
 
     if (eject) {
-        size_t next = rand() % entries_per_bucket;
+        size_t next = rng.nextBelow(entries_per_bucket);
         prev_fp = getFingerprint(i, next);
         insertFingerprint(i, next, fp);
     }
@@ -242,24 +526,102 @@ CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::replacingFingerprintInser
 
 
 template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
-bool CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::containsFingerprint(const size_t i, const uint32_t fp) {
-    const uint8_t *bucket = buckets[i].data;
-    uint64_t val = *((uint64_t *) bucket);
+inline bool CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::probeBucket(const size_t i, const uint32_t fp) {
+    uint64_t val = loadBucket(i);
+
+    return bit_manager::hasvalue(val, fp);
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline bool CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::probePair(const size_t i1, const size_t i2,
+                                                                            const uint32_t fp) {
+    uint64_t val1 = loadBucket(i1);
+    uint64_t val2 = loadBucket(i2);
+
+    if constexpr (simd_probe) {
+        return probeBucketPair<bits_per_fp, bytes_per_bucket>(val1, val2, fp);
+    }
+    return bit_manager::hasvalue(val1, fp) || bit_manager::hasvalue(val2, fp);
+}
+
 
-    return bit_manager->hasvalue(val, fp);
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::
+probePairs(const size_t *i1, const size_t *i2, const uint32_t *fps, const size_t count, bool *out) {
+    size_t k = 0;
+    if constexpr (simd_probe) {
+        k = probeBucketPairs(memory.data, bytes_per_bucket, bits_per_fp, i1, i2, fps, count, out);
+    }
+    for (; k < count; k++) {
+        out[k] = bit_manager::hasvalue(loadBucket(i1[k]), fps[k]) || bit_manager::hasvalue(loadBucket(i2[k]), fps[k]);
+    }
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+bool CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::containsFingerprint(const size_t i, const uint32_t fp) {
+    if (!versions) {
+        return probeBucket(i, fp);
+    }
+    while (true) {
+        uint32_t v = readBegin(i);
+        bool found = probeBucket(i, fp);
+        if (!readRetry(i, v)) {
+            return found;
+        }
+    }
 }
 
 
 template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 bool CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::containsFingerprint(const size_t i1, const size_t i2,
                                                                                 const uint32_t fp) {
-    const uint8_t *b1 = buckets[i1].data;
-    const uint8_t *b2 = buckets[i2].data;
+    if (!versions) {
+        return probePair(i1, i2, fp);
+    }
+    // both buckets are validated together, fingerprint moved between them is seen in at least one
+    while (true) {
+        uint32_t v1 = readBegin(i1);
+        uint32_t v2 = readBegin(i2);
+        bool found = probePair(i1, i2, fp);
+        if (!readRetry(i1, v1) && !readRetry(i2, v2)) {
+            return found;
+        }
+    }
+}
+
+
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::
+containsFingerprints(const size_t *i1, const size_t *i2, const uint32_t *fps, const size_t count, bool *out) {
+    if (!versions) {
+        probePairs(i1, i2, fps, count, out);
+        return;
+    }
+
+    const size_t chunk = 64;
+    uint32_t v1[chunk], v2[chunk];
+    for (size_t start = 0; start < count; start += chunk) {
+        size_t n = std::min(chunk, count - start);
+        for (size_t k = 0; k < n; k++) {
+            v1[k] = readBegin(i1[start + k]);
+            v2[k] = readBegin(i2[start + k]);
+        }
+        probePairs(i1 + start, i2 + start, fps + start, n, out + start);
+        // elements whose buckets were written meanwhile are probed again one by one
+        for (size_t k = 0; k < n; k++) {
+            if (readRetry(i1[start + k], v1[k]) || readRetry(i2[start + k], v2[k])) {
+                out[start + k] = containsFingerprint(i1[start + k], i2[start + k], fps[start + k]);
+            }
+        }
+    }
+}
 
-    uint64_t val1 = *((uint64_t *) b1);
-    uint64_t val2 = *((uint64_t *) b2);
 
-    return bit_manager->hasvalue(val1, fp) || bit_manager->hasvalue(val2, fp);
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+inline void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::prefetchBucket(const size_t i) const {
+    __builtin_prefetch(buckets[i].data, 0, 1);
 }
 
 
@@ -275,6 +637,20 @@ bool CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::deleteFingerprint(co
 }
 
 
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::splitInto(CuckooTable &target, const unsigned fp_bit) {
+    assert(target.table_size == 2 * table_size);
+    for (size_t i = 0; i < table_size; i++) {
+        for (size_t j = 0; j < entries_per_bucket; j++) {
+            uint32_t fp = getFingerprint(i, j);
+            if (fp != 0) {
+                target.insertFingerprint(2 * i + ((fp >> fp_bit) & 1), j, fp);
+            }
+        }
+    }
+}
+
+
 template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 size_t CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::
 getNumOfFreeEntries() {
@@ -296,10 +672,12 @@ void CuckooTable<entries_per_bucket, bits_per_fp, fp_type>::printTable() {
         std::cout << i << " | ";
         for (int j = 0; j < entries_per_bucket; ++j) {
             auto bucket = buckets[i].data;
-            uint32_t fp = bit_manager->read(j, bucket);
+            uint32_t fp = bit_manager::read(j, bucket);
             std::cout << std::setfill('0') << std::setw(8) << std::hex << fp << " ";
         }
         std::cout << std::endl;
     }
     std::cout << std::dec;
-}
\ No newline at end of file
+}
+
+#endif
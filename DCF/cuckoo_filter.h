@@ -56,11 +56,6 @@ private:
 
 public:
 
-    // pointer to previous cuckoo filter in linked list
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* prev = NULL;
-    // pointer to next cuckoo filter in linked list
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* next = NULL;
-
     // true if filter is full, false otherwise
     bool is_full = false;
     // true if filter is empty, false otherwise
@@ -77,10 +72,34 @@ public:
      * of entries per bucket.
      *
      * @param max_table_size Maximum table size
+     * @param seed Seed of generator choosing evicted entries
      */
     explicit CuckooFilter(uint32_t table_size,
-                          BitManager<fp_type>* bit_manager,
-                          uint32_t fp_mask);
+                          uint32_t fp_mask,
+                          MemoryPolicy policy = MemoryPolicy::CACHE_ALIGNED,
+                          uint64_t seed = DEFAULT_SEED);
+
+    /**
+     * Constructing cuckoo filter over existing buckets, e.g. loaded from file or taken from arena of dynamic
+     * filter. Table is only a view of given storage.
+     *
+     * @param table_size Table size
+     * @param fp_mask Fingerprint mask
+     * @param data Bucket storage followed by 8 bytes of padding
+     * @param stride Distance of successive buckets in bytes, 0 for packed buckets
+     * @param element_count Number of stored elements
+     * @param is_full True if filter is regarded as full
+     * @param seed Seed of generator choosing evicted entries
+     */
+    CuckooFilter(uint32_t table_size, uint32_t fp_mask, uint8_t *data, size_t stride, size_t element_count,
+                 bool is_full, uint64_t seed = DEFAULT_SEED);
+
+    /**
+     * Retrieves size of table's bucket array in bytes, without padding.
+     *
+     * @return size of buckets in bytes
+     */
+    size_t getBucketBytes() const;
 
     /**
      * Inserting element into Cuckoo Filter. In first pass, fingerprint and index are calculated,
@@ -153,6 +172,20 @@ public:
      */
     void moveElements(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf);
 
+    /**
+     * Attempts to transfer elements stored in buckets [first_bucket, last_bucket) to the table of cuckoo
+     * filter provided as argument. Fingerprint goes to free entry of the same bucket or of its alternate
+     * bucket, both are probed in every filter. Empty buckets are skipped as a whole. Stops early when the
+     * other filter gets full or this one empty.
+     *
+     * @param cf
+     * @param first_bucket First scanned bucket
+     * @param last_bucket Bucket after the last scanned one
+     * @return bucket at which the scan stopped, last_bucket if all buckets were scanned
+     */
+    size_t moveElements(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf,
+                        size_t first_bucket, size_t last_bucket);
+
     /**
      * Destructor that is in charge of memory clean-up.
      */
@@ -201,10 +234,28 @@ refreshOnInsert() {
 
 template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
-CuckooFilter(uint32_t table_size, BitManager<fp_type>* bit_manager, uint32_t fp_mask) {
+CuckooFilter(uint32_t table_size, uint32_t fp_mask, MemoryPolicy policy, uint64_t seed) {
     capacity = size_t(0.9 * table_size * entries_per_bucket);
     element_count = 0;
-    table = new CuckooTable<fp_type, entries_per_bucket, bits_per_fp>(table_size, bit_manager, fp_mask);
+    table = new CuckooTable<fp_type, entries_per_bucket, bits_per_fp>(table_size, fp_mask, policy, seed);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+CuckooFilter(uint32_t table_size, uint32_t fp_mask, uint8_t *data, size_t stride, size_t element_count,
+             bool is_full, uint64_t seed) {
+    capacity = size_t(0.9 * table_size * entries_per_bucket);
+    this->element_count = element_count;
+    this->is_full = is_full;
+    this->is_empty = (element_count == 0);
+    table = new CuckooTable<fp_type, entries_per_bucket, bits_per_fp>(table_size, fp_mask, data, stride, seed);
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::getBucketBytes() const {
+    return table->getBucketBytes();
 }
 
 
@@ -286,22 +337,32 @@ replacementInsert(size_t i, size_t j, uint32_t fp) {
 template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
 void CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
 moveElements(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf) {
-    uint32_t fp;
+    moveElements(cf, 0, table->table_size);
+}
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+size_t CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+moveElements(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf,
+             size_t first_bucket, size_t last_bucket) {
+    uint32_t fp, unused;
+
+    for(size_t i = first_bucket; i < last_bucket; i++){
+        if(cf->is_full || this->is_empty) return i;
+        if(table->isBucketEmpty(i)) continue;
 
-    for(size_t i = 0; i < table->table_size; i++){
-        for(int j = 0; j < entries_per_bucket; j++){
+        for(size_t j = 0; j < entries_per_bucket && !cf->is_full; j++){
             fp = table->getFingerprint(i, j);
+            if(!fp) continue;
 
-            if(fp){
-                if(cf->is_full || this->is_empty) return;
-                if(cf->table->insertFingerprintIfEmpty(i, j, fp)){
-                    table->insertFingerprint(i, j, 0);
-                    this->refreshOnDelete();
-                    cf->refreshOnInsert();
-                }
+            if(cf->table->replacingFingerprintInsertion(i, fp, false, unused)
+               || cf->table->replacingFingerprintInsertion(indexComplement(i, fp), fp, false, unused)){
+                table->insertFingerprint(i, j, 0);
+                this->refreshOnDelete();
+                cf->refreshOnInsert();
             }
         }
     }
+    return last_bucket;
 }
 
 template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
@@ -4,6 +4,8 @@
 #include <iostream>
 
 #include "../Utils/bit_manager.h"
+#include "../Utils/memory_manager.h"
+#include "../Utils/random.h"
 
 
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
@@ -11,15 +13,37 @@ class CuckooTable {
 
 private:
     static const size_t bytes_per_bucket = (entries_per_bucket * bits_per_fp) / 8;
-    // manipulation with bits
-    BitManager<fp_type>* bit_manager;
+    // manipulation with bits, resolved at compile time
+    typedef BitManager<entries_per_bucket, bits_per_fp, fp_type> bit_manager;
 
-    struct Bucket {
-        uint8_t data[bytes_per_bucket];
-    };
+    // memory backing the buckets, aligned to cache line (or huge page)
+    MemoryBlock memory;
 
     // element storage
-    Bucket* buckets;
+    uint8_t* buckets;
+
+    // distance of successive buckets in bytes, larger than bucket when buckets of several tables are interleaved
+    size_t stride;
+
+    // generator choosing evicted entries
+    FastRandom rng;
+
+    /**
+     * Loading 64-bit word starting at bucket i. Buckets are packed, so the word may be unaligned
+     * and contain part of following bucket, storage is padded so that the last bucket can be loaded too.
+     *
+     * @param i Bucket index
+     * @return 64-bit word with bucket i in lowest bytes
+     */
+    inline uint64_t loadBucket(size_t i) const;
+
+    /**
+     * Retrieves address of bucket i.
+     *
+     * @param i Bucket index
+     * @return Pointer to the first byte of bucket
+     */
+    inline uint8_t* bucketData(size_t i) const;
 
 public:
     // number of buckets
@@ -30,13 +54,28 @@ public:
     /**
      *
      * @param table_size
-     * @param bit_manager
      * @param fp_mask
+     * @param policy
+     * @param seed
+     */
+    CuckooTable(size_t table_size, uint32_t fp_mask, MemoryPolicy policy = MemoryPolicy::CACHE_ALIGNED,
+                uint64_t seed = DEFAULT_SEED);
+
+    /**
+     * Constructing table as a view of buckets owned by somebody else, e.g. part of file mapping.
+     * Storage has to hold table_size buckets stride bytes apart followed by 8 bytes of padding and
+     * outlive the table. Stride larger than bucket size interleaves buckets of several tables.
+     *
+     * @param table_size
+     * @param fp_mask
+     * @param data Bucket storage
+     * @param stride Distance of successive buckets in bytes, 0 for packed buckets
+     * @param seed
      */
-    CuckooTable(size_t table_size, BitManager<fp_type>* bit_manager, uint32_t fp_mask);
+    CuckooTable(size_t table_size, uint32_t fp_mask, uint8_t *data, size_t stride = 0, uint64_t seed = DEFAULT_SEED);
 
     /**
-     * Deleting all entries from cuckoo table and deleting bit manager.
+     * Deleting all entries from cuckoo table.
      */
     ~CuckooTable();
 
@@ -46,6 +85,53 @@ public:
      */
     size_t getTableSize() const;
 
+    /**
+     * Retrieves size of bucket array in bytes, without padding.
+     * @return size of buckets in bytes
+     */
+    size_t getBucketBytes() const;
+
+    /**
+     * Size of bucket array of table with given number of buckets, without padding.
+     *
+     * @param table_size Number of buckets
+     * @return size of buckets in bytes
+     */
+    static size_t bucketBytes(size_t table_size);
+
+    /**
+     * Prefetching buckets i1 and i2 of given bucket array.
+     *
+     * @param data Bucket array
+     * @param i1 First bucket index
+     * @param i2 Second bucket index
+     */
+    static inline void prefetchBuckets(const uint8_t* data, size_t i1, size_t i2);
+
+    /**
+     * Checking if fingerprint is contained in bucket i1 or i2 of given bucket array. Table object is not
+     * accessed, so that dynamic filter can probe bucket arrays of all its filters directly.
+     *
+     * @param data Bucket array
+     * @param i1 First checking index
+     * @param i2 Second checking index
+     * @param fp Fingerprint to check
+     * @return True if element is contained
+     */
+    static inline bool containsFingerprint(const uint8_t* data, size_t i1, size_t i2, uint32_t fp);
+
+    /**
+     * Checking buckets of count interleaved tables, which are stored next to each other in rows row1
+     * and row2, usually the same cache line of every row.
+     *
+     * @param row1 Buckets i1 of all tables
+     * @param row2 Buckets i2 of all tables
+     * @param count Number of tables
+     * @param fp Fingerprint to check
+     * @return position of the first table containing fingerprint in row, or -1
+     */
+    static inline long findInRows(const uint8_t* row1, const uint8_t* row2, size_t count, uint32_t fp);
+
     /**
       * Returning maximum number of elements stored in table.
       *
@@ -70,6 +156,14 @@ public:
      */
     size_t fingerprintCount(size_t i) const;
 
+    /**
+     * Checking if bucket stores no fingerprint, by its bytes instead of single entries.
+     *
+     * @param i Bucket index
+     * @return True if bucket is empty
+     */
+    inline bool isBucketEmpty(size_t i) const;
+
     /**
      * Inserting fingerprint in bucket with index i and entry index j.
      *
@@ -145,13 +239,14 @@ public:
 
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
 CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
-CuckooTable(size_t table_size, BitManager<fp_type>* bit_manager, uint32_t fp_mask) {
+CuckooTable(size_t table_size, uint32_t fp_mask, MemoryPolicy policy, uint64_t seed) : rng(seed) {
     this->table_size = table_size;
-    this->bit_manager = bit_manager;
     this->fp_mask = fp_mask;
 
-    buckets = new Bucket[table_size];
-    memset(buckets, 0, bytes_per_bucket * table_size); // set all bits to 0
+    // padding for 64-bit load of the last bucket, all bits are set to 0 by memory manager
+    memory = allocateMemory(bytes_per_bucket * table_size + sizeof(uint64_t), policy);
+    buckets = memory.data;
+    stride = bytes_per_bucket;
 
    /*   // when buckets are allocated on heap
     *
@@ -161,9 +256,20 @@ CuckooTable(size_t table_size, BitManager<fp_type>* bit_manager, uint32_t fp_mas
     }*/
 }
 
+template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
+CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
+CuckooTable(size_t table_size, uint32_t fp_mask, uint8_t *data, size_t stride, uint64_t seed) : rng(seed) {
+    this->table_size = table_size;
+    this->fp_mask = fp_mask;
+
+    // memory block stays empty, so the view is not released
+    buckets = data;
+    this->stride = stride ? stride : bytes_per_bucket;
+}
+
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
 CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::~CuckooTable() {
-    delete[] buckets;
+    releaseMemory(memory);
 }
 
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
@@ -171,16 +277,68 @@ size_t CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::getTableSize() con
     return table_size;
 }
 
+template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
+size_t CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::getBucketBytes() const {
+    return bucketBytes(table_size);
+}
+
+template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
+size_t CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::bucketBytes(size_t table_size) {
+    return bytes_per_bucket * table_size;
+}
+
+template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
+inline void CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
+prefetchBuckets(const uint8_t* data, const size_t i1, const size_t i2) {
+    __builtin_prefetch(data + i1 * bytes_per_bucket);
+    __builtin_prefetch(data + i2 * bytes_per_bucket);
+}
+
+template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
+inline bool CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
+containsFingerprint(const uint8_t* data, const size_t i1, const size_t i2, const uint32_t fp) {
+    uint64_t val1, val2;
+    memcpy(&val1, data + i1 * bytes_per_bucket, sizeof(val1));
+    memcpy(&val2, data + i2 * bytes_per_bucket, sizeof(val2));
+    return bit_manager::hasvalue(val1, fp) || bit_manager::hasvalue(val2, fp);
+}
+
+template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
+inline long CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
+findInRows(const uint8_t* row1, const uint8_t* row2, const size_t count, const uint32_t fp) {
+    for (size_t k = 0; k < count; k++) {
+        uint64_t val1, val2;
+        memcpy(&val1, row1 + k * bytes_per_bucket, sizeof(val1));
+        memcpy(&val2, row2 + k * bytes_per_bucket, sizeof(val2));
+        if (bit_manager::hasvalue(val1, fp) || bit_manager::hasvalue(val2, fp)) {
+            return k;
+        }
+    }
+    return -1;
+}
+
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
 size_t CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::maxNoOfElements() {
     return entries_per_bucket * table_size;
 }
 
+template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
+inline uint64_t CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::loadBucket(const size_t i) const {
+    uint64_t val;
+    memcpy(&val, bucketData(i), sizeof(val));
+    return val;
+}
+
+template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
+inline uint8_t* CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::bucketData(const size_t i) const {
+    return buckets + i * stride;
+}
+
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
 inline uint32_t CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
 getFingerprint(const size_t i, const size_t j) {
-    const uint8_t *bucket = buckets[i].data;
-    uint32_t fp = bit_manager->read(j, bucket);
+    const uint8_t *bucket = bucketData(i);
+    uint32_t fp = bit_manager::read(j, bucket);
     return fp & fp_mask;
 }
 
@@ -196,14 +354,25 @@ fingerprintCount(const size_t i) const {
     return count;
 }
 
+template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
+inline bool CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::isBucketEmpty(const size_t i) const {
+    // empty entries are zero and fingerprints are masked on write, so empty bucket has all bytes zero
+    const uint8_t *bucket = bucketData(i);
+    uint8_t bits = 0;
+    for (size_t b = 0; b < bytes_per_bucket; b++) {
+        bits |= bucket[b];
+    }
+    return bits == 0;
+}
+
 
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
 bool CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
 insertFingerprintIfEmpty(const size_t i, const size_t j, const uint32_t fp) {
     if (getFingerprint(i, j) == 0) {
-        const uint8_t *bucket = buckets[i].data;
+        const uint8_t *bucket = bucketData(i);
         uint32_t efp = fp & fp_mask;
-        bit_manager->write(j, bucket, efp);
+        bit_manager::write(j, bucket, efp);
         return true;
     } else {
         return false;
@@ -213,9 +382,9 @@ insertFingerprintIfEmpty(const size_t i, const size_t j, const uint32_t fp) {
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
 void CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
 insertFingerprint(const size_t i, const size_t j, const uint32_t fp) {
-    const uint8_t *bucket = buckets[i].data;
+    const uint8_t *bucket = bucketData(i);
     uint32_t efp = fp & fp_mask;
-    bit_manager->write(j, bucket, efp);
+    bit_manager::write(j, bucket, efp);
 }
 
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
@@ -230,7 +399,7 @@ replacingFingerprintInsertion(const size_t i, const uint32_t fp,
     }
 
     if (eject) {
-        size_t next = rand() % entries_per_bucket;
+        size_t next = rng.nextBelow(entries_per_bucket);
         prev_fp = getFingerprint(i, next);
         insertFingerprint(i, next, fp);
     }
@@ -241,21 +410,18 @@ replacingFingerprintInsertion(const size_t i, const uint32_t fp,
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
 bool CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
 containsFingerprint(const size_t i, const uint32_t fp) {
-    const uint8_t *bucket = buckets[i].data;
-    uint64_t val = *((uint64_t *)bucket);
+    uint64_t val = loadBucket(i);
 
-    return bit_manager->hasvalue(val, fp);
+    return bit_manager::hasvalue(val, fp);
 }
 
 template<typename fp_type, size_t entries_per_bucket, size_t bits_per_fp>
 bool CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
 containsFingerprint(const size_t i1, const size_t i2, const uint32_t fp) {
     return
-            bit_manager->hasvalue(
-                    *((uint64_t *)buckets[i1].data), fp)
+            bit_manager::hasvalue(loadBucket(i1), fp)
             ||
-            bit_manager->hasvalue(
-                    *((uint64_t *)buckets[i2].data), fp);
+            bit_manager::hasvalue(loadBucket(i2), fp);
 
 }
 
@@ -1,14 +1,52 @@
 #include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../Utils/filter_file.h"
 #include "../Utils/hash_function.h"
+#include "../Utils/table_arena.h"
+#include "../Utils/thread_pool.h"
 #include "../Utils/util.h"
 #include "cuckoo_filter.h"
 
+// number of cuckoo filters whose buckets are prefetched ahead of the probed one
+#define DCF_PREFETCH_DISTANCE 4
+// default number of cuckoo filters from which single lookups fan out to thread pool, waking the pool costs
+// about as much as probing 150 - 250 filters of 1e6 buckets sequentially
+#define DCF_PARALLEL_LOOKUP_MIN_FILTERS 256
+// number of cuckoo filters probed by one task of parallel lookup, hit ends the lookup after current tasks
+#define DCF_PARALLEL_CHUNK 16
+// number of elements looked up by one task of parallel batched lookup
+#define DCF_PARALLEL_BATCH 256
+// with geometric growth, tables of further levels are not larger than this number of buckets
+#define DCF_MAX_LEVEL_TABLE_SIZE (1UL << 30)
+// position returned by findElement for deletion when element matches cuckoo filters of several levels
+#define DCF_SEVERAL_LEVELS (-2)
+
+/**
+ * Outcome of deletion from dynamic cuckoo filter.
+ */
+enum class DeletionResult {
+    // fingerprint of element was removed
+    DELETED,
+    // no cuckoo filter contains element
+    ABSENT,
+    // with geometric growth element matches filters of several levels and its fingerprint can not be told apart,
+    // nothing is removed and element stays as a false positive
+    AMBIGUOUS
+};
+
 /**
  *
  * Dynamic Cuckoo Filter is a space-efficient probabilistic data structure that is used to test whether an
  * element is a member of a set, like a Bloom filter does. It uses additional structures for dynamic
- * surroundings. Basically, it keeps multiple cuckoo filter in a linked list.
+ * surroundings. Basically, it keeps multiple cuckoo filters in a vector, their tables are carved out of one arena.
  * False positive matches are possible, but false negatives are not – in other words,
  * a query returns either "possibly in set" or "definitely not
  * in set". Constructing Cuckoo Filter with specific table size, number of bits per fingerprint and number
@@ -29,24 +67,67 @@ private:
     // used for computing hash values
     HashFunction* hash_function_;
 
-    // operations with bits
-    BitManager<fp_type>* bit_manager_;
-
     // mask for extracting lower bits
     uint32_t fp_mask_;
 
-    // table size per one cuckoo filter
+    // table size per one cuckoo filter, of the first level with geometric growth
     int cf_table_size_;
 
+    // log2 of factor by which tables of every level are larger than tables of the previous one
+    size_t growth_shift_;
+    // fingerprint bits of the first level, every further level uses one bit more up to bits_per_fp
+    size_t min_fp_bits_;
+    // true if cuckoo filters are created in levels differing in table size or fingerprint bits
+    bool geometric_;
+
+    // policy of allocating tables of cuckoo filters
+    MemoryPolicy memory_policy_;
+
+    // generator of seeds for cuckoo filters, every filter evicts with its own generator
+    FastRandom seeds_;
+
     // helper structure
     Victim victim_;
 
-    // head cuckoo filter in linked list
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* head_cf_;
-    // tail cuckoo filter in linked list
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* tail_cf_;
-    // active cuckoo filter in linked list
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* active_cf_;
+    // cuckoo filters in order of creation
+    std::vector<CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>*> filters_;
+    // bucket arrays of cuckoo filters in the same order, lookups probe them without touching filter objects
+    std::vector<uint8_t*> tables_;
+    // levels of cuckoo filters in the same order, all 0 without geometric growth
+    std::vector<size_t> levels_;
+    // position of active cuckoo filter
+    size_t active_;
+    // min-heap of (element count, position) of cuckoo filters which are not full, except the active one.
+    // Counts grow with insertions, so entries are checked when taken from heap and full filters are skipped.
+    std::vector<std::pair<size_t, size_t>> free_index_;
+
+    // number of cuckoo filters in group with interleaved buckets, bucket i of all filters of a group is stored
+    // in one row, 1 keeps tables separate
+    size_t group_size_;
+
+    // bucket arrays of cuckoo filters are carved out of arena of their level, created on first use
+    std::vector<TableArena*> arenas_;
+    // maximal number of resident free tables of every arena
+    size_t max_free_tables_;
+
+    // mapping of loaded file, tables of loaded cuckoo filters are views into it
+    MemoryBlock mapping_;
+
+    // threads probing cuckoo filters in parallel, lookups are sequential without pool
+    ThreadPool* pool_ = nullptr;
+    // single lookups and deletions use pool only with at least this many cuckoo filters, 0 keeps them sequential
+    size_t parallel_lookup_filters_ = 0;
+
+    // cuckoo filters which are not full at start of running compaction, the first ones are emptied into
+    // the last ones, empty if no compaction runs
+    std::vector<CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>*> compact_queue_;
+    // levels of queued filters, elements are moved only between filters of the same level
+    std::vector<size_t> compact_levels_;
+    // positions in queue of filter being emptied and of filter receiving its elements
+    size_t compact_source_;
+    size_t compact_target_;
+    // next bucket of source moved to target
+    size_t compact_bucket_;
 
     /**
     * Gets index from previously calculated hash value.
@@ -85,44 +166,224 @@ private:
     inline uint32_t indexComplement(const size_t index, const uint32_t fp) const;
 
     /**
-     * Sorts array of cuckoo filters that are not completely full in the
-     * descending order regarding the number of elements stored in single
-     * cuckoo table.
+     * Retrieves table size of cuckoo filters of given level.
      *
-     * @param cfq
-     * @param count
+     * @param level Level of cuckoo filter
+     * @return table size
      */
-    void sort(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>** cfq,
-              int count);
+    inline size_t levelTableSize(size_t level) const;
 
     /**
-     * Removes cuckoo filter from linked list. Memory that this single cuckoo
-     * filter occupied is now cleared.
+     * Retrieves fingerprint mask of cuckoo filters of given level.
+     *
+     * @param level Level of cuckoo filter
+     * @return fingerprint mask
+     */
+    inline uint32_t levelFpMask(size_t level) const;
+
+    /**
+     * Retrieves the last level whose table size or fingerprint bits differ from the previous level,
+     * further filters are created on this level, so that compaction can pair them.
+     *
+     * @return last level
+     */
+    inline size_t lastLevel() const;
+
+    /**
+     * Calculating fingerprint and both indices of element in cuckoo filters of given level.
+     *
+     * @param hash_value Hash value of element
+     * @param level Level of cuckoo filter
+     * @param fp Fingerprint pointer
+     * @param i1 First index pointer
+     * @param i2 Second index pointer
+     */
+    inline void levelPass(uint64_t hash_value, size_t level, uint32_t *fp, size_t *i1, size_t *i2) const;
+
+    /**
+     * Retrieves arena of tables of given level, creating it if needed.
+     *
+     * @param level Level of cuckoo filter
+     * @return arena of level
+     */
+    TableArena* levelArena(size_t level);
+
+    /**
+     * Removes cuckoo filter from list of filters. Its table is returned to arena for reuse.
+     * Empty filter with interleaved buckets is kept in its group.
      *
      * @param cf
      */
     void removeCF(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf);
 
+    /**
+     * Appends cuckoo filter over given bucket array to list of filters.
+     *
+     * @param data Bucket array followed by padding
+     * @param count Number of elements stored in bucket array
+     * @param is_full True if filter is regarded as full
+     * @return position of new cuckoo filter
+     */
+    size_t addCF(uint8_t* data, size_t count = 0, bool is_full = false, size_t level = 0);
+
+    /**
+     * Appends new empty cuckoo filter. With interleaved buckets its table is the next free member of the
+     * last group, new group is taken from arena only when the last one is complete. With geometric growth
+     * the filter starts a new level after the highest existing one, up to lastLevel.
+     *
+     * @return position of new cuckoo filter
+     */
+    size_t growCF();
+
+    /**
+     * Appends new empty cuckoo filter of given level.
+     *
+     * @param level Level of cuckoo filter
+     * @return position of new cuckoo filter
+     */
+    size_t growCF(size_t level);
+
+    /**
+     * Adds cuckoo filter to index of filters which are not full.
+     *
+     * @param position Position of cuckoo filter
+     */
+    void indexCF(size_t position);
+
+    /**
+     * Rebuilds index of filters which are not full, after positions of filters changed.
+     */
+    void rebuildIndex();
+
+    /**
+     * Takes the least occupied cuckoo filter which is not full and not active out of index, or appends
+     * new cuckoo filter if there is none.
+     *
+     * @return position of cuckoo filter
+     */
+    size_t takeCF();
+
+    /**
+     * Chooses cuckoo filter for element evicted from filter at given position. Without geometric growth
+     * it is taken from index, otherwise evicted bucket index and fingerprint are valid only in filters of
+     * the same level, so the first such filter which is not full, not active and not tried yet is chosen,
+     * new filter of the level is appended if there is none.
+     *
+     * @param position Position of filter which evicted the element
+     * @param tried Positions of filters which already failed to store the element
+     * @return position of cuckoo filter
+     */
+    size_t victimCF(size_t position, const std::vector<size_t> &tried);
+
+    /**
+     * Releases trailing groups of interleaved tables whose cuckoo filters are all empty, the first group is kept.
+     */
+    void trimGroups();
+
+    /**
+     * Starts compaction pass by queueing cuckoo filters which are not full, sorted by level and then by
+     * number of elements. With interleaved buckets they are queued from the last one instead.
+     */
+    void startCompaction();
+
+    /**
+     * Ends compaction pass, releases trailing empty groups of interleaved tables.
+     */
+    void finishCompaction();
+
+    /**
+     * Runs whole compaction pass with disjoint pairs of cuckoo filters processed in parallel. Sparser half
+     * of filters of every level moves elements to denser half of the level, in every round each sparse filter
+     * is paired with another dense filter, so that after all rounds every sparse filter tried every dense one.
+     */
+    void compactInParallel();
+
+    /**
+     * Finds the first cuckoo filter of groups [first, last) containing fingerprint in bucket i1 or i2. Bucket
+     * offsets are the same in all tables, tables are probed in order with buckets of following
+     * DCF_PREFETCH_DISTANCE tables prefetched, so cache misses of successive tables overlap. With interleaved
+     * buckets, rows i1 and i2 are probed group by group and groups are prefetched instead. Without
+     * interleaving, every group consists of one filter.
+     *
+     * @param i1 First bucket index
+     * @param i2 Second bucket index
+     * @param fp Fingerprint
+     * @param first First group
+     * @param last Group after the last one
+     * @return position of cuckoo filter, or -1 if no filter contains fingerprint
+     */
+    inline long probeGroups(size_t i1, size_t i2, uint32_t fp, size_t first, size_t last) const;
+
+    /**
+     * Finds cuckoo filter containing fingerprint in bucket i1 or i2. With parallel lookups enabled and at least
+     * the set number of filters, chunks of DCF_PARALLEL_CHUNK filters are probed in parallel and
+     * chunks not started yet are skipped after a hit, so returned filter need not be the first one.
+     *
+     * @param i1 First bucket index
+     * @param i2 Second bucket index
+     * @param fp Fingerprint
+     * @return position of cuckoo filter, or -1 if no filter contains fingerprint
+     */
+    long findFingerprint(size_t i1, size_t i2, uint32_t fp) const;
+
+    /**
+     * Finds cuckoo filter containing element with geometric growth, where fingerprint and indices are
+     * calculated for every level. Fingerprints of different levels differ, so a match in one filter may
+     * belong to another element. Matches on a single level are interchangeable as in filters of the same
+     * size, so deletion accepts only those and leaves an element matching several levels as a false
+     * positive. Lookup stops at the first match.
+     *
+     * @param hash_value Hash value of element
+     * @param single_level If true, all filters are probed and match is returned only if all matches are
+     *        in filters of the same level
+     * @return position of cuckoo filter, -1 if no filter contains element, or DCF_SEVERAL_LEVELS if matches
+     *         are on several levels
+     */
+    long findElement(uint64_t hash_value, bool single_level = false) const;
+
+    /**
+     * Constructing dynamic cuckoo filter without any cuckoo filter, which are added by load.
+     *
+     * @param header Header of loaded file
+     * @param seed Seed from which seeds of single cuckoo filters are derived
+     */
+    DynamicCuckooFilter(const FilterFileHeader &header, uint64_t seed);
+
 
 public:
     // total number of stored elements
     size_t element_count;
     // number of cuckoo filters
     size_t cf_count;
+    // total size of tables released by compaction in bytes
+    size_t reclaimed_bytes;
 
     /**
       *
       * Dynamic Cuckoo Filter is a space-efficient probabilistic data structure that is used to test whether an
       * element is a member of a set, like a Bloom filter does. It uses additional structures for dynamic
-      * surroundings. Basically, it keeps multiple cuckoo filter in a linked list.
+      * surroundings. Basically, it keeps multiple cuckoo filters in a vector, their tables are carved out of one arena.
       * False positive matches are possible, but false negatives are not – in other words,
       * a query returns either "possibly in set" or "definitely not
       * in set". Constructing Cuckoo Filter with specific table size, number of bits per fingerprint and number
       * of entries per bucket.
       *
       * @param max_table_size Maximum table size
+      * @param policy Policy of allocating tables of single cuckoo filters
+      * @param seed Seed from which seeds of single cuckoo filters are derived
+      * @param group_size Number of cuckoo filters whose buckets are interleaved, so that bucket i of all of them
+      *        lies in one row, preferably one cache line. Growth then adds groups of tables and negative lookup
+      *        touches two rows per group instead of two buckets per filter. 1 keeps tables separate.
+      * @param growth_factor Power of two by which table of every new cuckoo filter is larger than table of
+      *        the previous one, up to DCF_MAX_LEVEL_TABLE_SIZE buckets, so that number of filters grows
+      *        logarithmically with number of elements. 1 keeps all tables of the same size.
+      * @param min_fp_bits Fingerprint bits of the first cuckoo filter, every new filter uses one bit more up to
+      *        bits_per_fp. Sum of false positive rates of all filters then stays below twice the rate of the
+      *        first one, however many filters are added. Fingerprints are stored in bits_per_fp bits anyway.
       */
-    DynamicCuckooFilter(uint32_t max_table_size);
+    DynamicCuckooFilter(uint32_t max_table_size, MemoryPolicy policy = MemoryPolicy::CACHE_ALIGNED,
+                        uint64_t seed = DEFAULT_SEED, size_t group_size = 1, size_t growth_factor = 1,
+                        size_t min_fp_bits = bits_per_fp);
 
     /**
      * Destructor that is in charge of memory clean-up.
@@ -130,24 +391,25 @@ public:
     ~DynamicCuckooFilter();
 
     /**
-     * Retrieves single cuckoo filter that comes next
-     * after given one in the stored linked list.
+     * Retrieves position of the first cuckoo filter after given one
+     * which is not full. New cuckoo filter is appended if there is none.
      *
-     * @param cf
-     * @return next cuckoo filter in linked list
+     * @param position
+     * @return position of next cuckoo filter
      */
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>*
-            nextCF(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf);
+    size_t nextCF(size_t position);
 
     /**
      * Attempt to store element cached in "victim" structure to one of cuckoo filters'
-     * actual table.
+     * actual table, starting with filter at given position. If insertion fails, element
+     * evicted from the filter is stored to the least occupied filters which are not full,
+     * until some of them takes it, new filter is appended when none is left.
      *
      * @param victim
-     * @param cf
+     * @param position
+     * @return position of cuckoo filter which stored the victim
      */
-    void storeVictim(Victim &victim,
-                     CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf);
+    size_t storeVictim(Victim &victim, size_t position);
 
     /**
       * Inserting element into Dynamic Cuckoo Filter. In first pass, fingerprint and index are calculated,
@@ -168,23 +430,76 @@ public:
       */
     bool containsElement(const element_type &element);
 
+    /**
+     *  Checking if elements are contained in Dynamic Cuckoo Filter. With thread pool, elements are
+     *  split into chunks of DCF_PARALLEL_BATCH looked up in parallel.
+     *
+     * @param elements Elements for checking
+     * @param count Number of elements
+     * @param out Output array of size count, out[k] is true if elements[k] is contained
+     */
+    void containsElements(const element_type* elements, size_t count, bool* out);
+
     /**
      *  Deleting element from Cuckoo Filter. Algorithm requires checking both primary and secondary index,
-     *  if any of them contain fingerprint, it is removed from structure.
+     *  if any of them contain fingerprint, it is removed from structure. With geometric growth, element
+     *  matching filters of several levels is not deleted, as its fingerprint can not be told apart.
      *
      * @param element Element for deletion
-     * @return True if item is deleted
+     * @return DELETED if item is deleted, ABSENT if it is not contained, AMBIGUOUS if it is kept as it
+     *         matches several levels
      */
-    bool deleteElement(const element_type &element);
+    DeletionResult deleteElement(const element_type &element);
 
     /**
      * Tries to transfer elements from sparse cuckoo filters to almost full ones.
      * The ultimate goal is to clean very sparse filters to reduce total
      * number of cuckoo filters.
      * This method should be called by user every once in a while when inserting
-     * a lot of elements.
+     * a lot of elements. Compaction pass started by compactStep is abandoned and
+     * whole new pass is run, with thread pool pairs of filters are processed in parallel.
+     *
+     * @return size of tables released by this pass in bytes
+     */
+    size_t compact();
+
+    /**
+     * Continues compaction pass, starting new one if none runs, by moving elements of at most max_buckets
+     * buckets. Insertions, lookups and deletions can be called between steps, so long pass does not
+     * block them. Released memory is added to reclaimed_bytes.
+     *
+     * @param max_buckets Maximal number of scanned buckets
+     * @return True if the pass is finished
+     */
+    bool compactStep(size_t max_buckets);
+
+    /**
+     * Lets batched lookups process elements in parallel and compaction move elements between disjoint
+     * pairs of filters in parallel. Single lookups and deletions stay sequential, see enableParallelLookups.
+     * Filter itself stays single-threaded, operations must not be called concurrently.
+     *
+     * @param threads Number of threads including the calling one, 1 turns parallelism off
      */
-    void compact();
+    void enableParallelism(size_t threads);
+
+    /**
+     * Lets single lookups and deletions probe chunks of cuckoo filters in parallel once there are at least
+     * min_filters of them. Waking the pool costs several microseconds, which pays off only with hundreds of
+     * filters, so the threshold should be taken from DynamicFilterLookupBenchmark on the target machine.
+     * Has effect only with thread pool of enableParallelism.
+     *
+     * @param min_filters Minimal number of filters probed in parallel, 0 keeps lookups sequential
+     */
+    void enableParallelLookups(size_t min_filters = DCF_PARALLEL_LOOKUP_MIN_FILTERS);
+
+    /**
+     * Sets how many tables released by compaction stay resident for reuse by growth, default is
+     * ARENA_MAX_FREE_TABLES. Pages of further released tables are returned to the system, so resident
+     * memory shrinks after bursts of deletions followed by compaction.
+     *
+     * @param tables Maximal number of resident free tables, groups of tables with interleaved buckets
+     */
+    void setMaxFreeTables(size_t tables);
 
     /**
      * Retrieves table size of a single cuckoo filter.
@@ -195,6 +510,30 @@ public:
         return this->cf_table_size_;
     }
 
+    /**
+     * Saving dynamic cuckoo filter into single file: header with template and hash function parameters,
+     * element count and victim, records with state of single cuckoo filters in list order, and their
+     * tables stored contiguously, each aligned to cache line. Temporary file is renamed over path once
+     * written, so a loaded filter may be saved into the file it was loaded from. std::runtime_error is
+     * thrown if file can not be written.
+     *
+     * @param path Path of the file
+     */
+    void save(const std::string &path) const;
+
+    /**
+     * Loading dynamic cuckoo filter saved by save. Whole file is mapped copy-on-write and tables of single
+     * cuckoo filters are views into the mapping, tables of filters added later come from arena, so loading takes the same time regardless of the number
+     * of elements and pages are read on first access. Loaded filter can be modified, modified pages are
+     * private to the process and file stays unchanged. std::runtime_error is thrown if file is not a
+     * dynamic filter saved with the same template parameters.
+     *
+     * @param path Path of the file
+     * @param seed Seed from which seeds of single cuckoo filters are derived
+     * @return Loaded filter, owned by caller
+     */
+    static DynamicCuckooFilter* load(const std::string &path, uint64_t seed = DEFAULT_SEED);
+
 };
 
 
@@ -241,44 +580,104 @@ indexComplement(const size_t index, const uint32_t fp) const {
     return getIndex(hv);
 }
 
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+inline size_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+levelTableSize(size_t level) const {
+    size_t shift = std::min(level * growth_shift_, (size_t) 32);
+    while (shift > 0 && ((size_t) cf_table_size_ << shift) > DCF_MAX_LEVEL_TABLE_SIZE) {
+        shift--;
+    }
+    return (size_t) cf_table_size_ << shift;
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+inline uint32_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+levelFpMask(size_t level) const {
+    size_t bits = std::min(min_fp_bits_ + level, bits_per_fp);
+    return (1ULL << bits) - 1;
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+inline size_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::lastLevel() const {
+    size_t level = 0;
+    while (levelTableSize(level + 1) != levelTableSize(level) || levelFpMask(level + 1) != levelFpMask(level)) {
+        level++;
+    }
+    return level;
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+inline void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+levelPass(uint64_t hash_value, size_t level, uint32_t *fp, size_t *i1, size_t *i2) const {
+    // indices are taken from the same hash bits as in the first level, larger tables use more of them
+    const size_t index_mask = levelTableSize(level) - 1;
+    *fp = hash_value & levelFpMask(level);
+    *fp += (*fp == 0);
+    *i1 = (hash_value >> 32) & index_mask;
+    *i2 = fingerprintComplement(*i1, *fp) & index_mask;
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+TableArena* DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::levelArena(size_t level) {
+    while (arenas_.size() <= level) {
+        // padding for 64-bit load of the last bucket
+        size_t table_bytes = group_size_ * CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
+                bucketBytes(levelTableSize(arenas_.size()));
+        arenas_.push_back(new TableArena(table_bytes + sizeof(uint64_t), memory_policy_, max_free_tables_));
+    }
+    return arenas_[level];
+}
+
 
 template<typename element_type,
         size_t entries_per_bucket,
         size_t bits_per_fp,
         typename fp_type>
 DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
-DynamicCuckooFilter(uint32_t max_table_size) {
+DynamicCuckooFilter(uint32_t max_table_size, MemoryPolicy policy, uint64_t seed, size_t group_size,
+                    size_t growth_factor, size_t min_fp_bits) : seeds_(seed) {
+    if (group_size == 0) {
+        throw std::runtime_error("Group of interleaved filters can not be empty");
+    }
+    if (growth_factor == 0 || (growth_factor & (growth_factor - 1)) != 0) {
+        throw std::runtime_error("Growth factor has to be a power of two");
+    }
+    if (min_fp_bits == 0 || min_fp_bits > bits_per_fp) {
+        throw std::runtime_error("Fingerprint bits of the first filter have to be between 1 and bits_per_fp");
+    }
     this->fp_mask_ = (1ULL << bits_per_fp) - 1;
     this->cf_table_size_ = highestPowerOfTwo(max_table_size);
-
-    if (entries_per_bucket == 4 && bits_per_fp == 4 && std::is_same<fp_type, uint8_t>::value) {
-        bit_manager_ = new BitManager4<fp_type>();
-    } else if (entries_per_bucket == 4 && bits_per_fp == 8 && std::is_same<fp_type, uint8_t>::value) {
-        bit_manager_ = new BitManager8<fp_type>();
-    } else if (entries_per_bucket == 4 && bits_per_fp == 12 && std::is_same<fp_type, uint16_t>::value) {
-        bit_manager_ = new BitManager12<fp_type>();
-    } else if (entries_per_bucket == 4 && bits_per_fp == 16 && std::is_same<fp_type, uint16_t>::value) {
-        bit_manager_ = new BitManager16<fp_type>();
-    } else if (entries_per_bucket == 2 && bits_per_fp == 32 && std::is_same<fp_type, uint32_t>::value) {
-        bit_manager_ = new BitManager32<fp_type>();
-    }  else {
-        throw std::runtime_error("Invalid parameters.\n"
-                                 "Supported parameter values for (entries_per_bucket, bits_per_fp, fp_type):\n"
-                                 "{(4,  4, uint8_t),\n"
-                                 " (4,  8, uint8_t),\n"
-                                 " (4, 12, uint16_t),\n"
-                                 " (4, 16, uint16_t),\n"
-                                 " (2, 32, uint32_t)}\n");
+    this->memory_policy_ = policy;
+    this->group_size_ = group_size;
+    this->growth_shift_ = __builtin_ctzll(growth_factor);
+    this->min_fp_bits_ = min_fp_bits;
+    this->geometric_ = growth_shift_ > 0 || min_fp_bits_ < bits_per_fp;
+    if (geometric_ && group_size_ > 1) {
+        throw std::runtime_error("Filters of different levels can not be interleaved");
     }
-
+    this->max_free_tables_ = ARENA_MAX_FREE_TABLES;
 
     hash_function_ = new HashFunction();
 
-    active_cf_ = new CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>
-            (this->cf_table_size_, this->bit_manager_, this->fp_mask_);
-    head_cf_ = tail_cf_ = active_cf_;
-    cf_count = 1;
+    cf_count = 0;
     element_count = 0;
+    reclaimed_bytes = 0;
+    active_ = growCF();
 }
 
 template<typename element_type,
@@ -287,55 +686,293 @@ template<typename element_type,
         typename fp_type>
 DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
 ~DynamicCuckooFilter() {
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf = head_cf_;
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* temp;
-    while (cf) {
-        temp = cf->next;
-        delete cf;
-        cf = temp;
+    for (size_t k = 0; k < filters_.size(); k++) {
+        delete filters_[k];
     }
 
-    delete bit_manager_;
+    for (size_t level = 0; level < arenas_.size(); level++) {
+        delete arenas_[level];
+    }
+
+    delete pool_;
     delete hash_function_;
+    releaseMemory(mapping_);
 }
 
 template<typename element_type,
         size_t entries_per_bucket,
         size_t bits_per_fp,
         typename fp_type>
-CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>*
-DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
-nextCF(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf) {
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* next_cf;
+size_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+addCF(uint8_t* data, size_t count, bool is_full, size_t level) {
+    const size_t stride = group_size_ * CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::bucketBytes(1);
+    filters_.push_back(new CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>
+            (levelTableSize(level), levelFpMask(level), data, stride, count, is_full, seeds_.next()));
+    tables_.push_back(data);
+    levels_.push_back(level);
+    cf_count++;
+    return filters_.size() - 1;
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+size_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::growCF() {
+    size_t level = 0;
+    if (geometric_) {
+        for (size_t k = 0; k < levels_.size(); k++) {
+            level = std::max(level, levels_[k] + 1);
+        }
+        level = std::min(level, lastLevel());
+    }
+    return growCF(level);
+}
 
-    if(cf == tail_cf_) {
-        next_cf = new CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>
-                (cf_table_size_, bit_manager_, fp_mask_);
-        active_cf_->next = next_cf;
-        next_cf->prev = active_cf_;
-        tail_cf_ = next_cf;
-        cf_count++;
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+size_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::growCF(size_t level) {
+    const size_t member = filters_.size() % group_size_;
+    if (member == 0) {
+        return addCF(levelArena(level)->acquire(), 0, false, level);
     }
-    else {
-        next_cf = active_cf_->next;
-        if(next_cf->is_full){
-            next_cf = nextCF(next_cf);
+    // first bucket of member is next to the first bucket of the first member of group
+    uint8_t* group = tables_[filters_.size() - member];
+    return addCF(group + member * CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::bucketBytes(1));
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::indexCF(size_t position) {
+    free_index_.push_back(std::make_pair(filters_[position]->element_count, position));
+    std::push_heap(free_index_.begin(), free_index_.end(), std::greater<std::pair<size_t, size_t>>());
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::rebuildIndex() {
+    free_index_.clear();
+    for (size_t k = 0; k < filters_.size(); k++) {
+        if (k != active_ && !filters_[k]->is_full) {
+            free_index_.push_back(std::make_pair(filters_[k]->element_count, k));
         }
     }
-    return next_cf;
+    std::make_heap(free_index_.begin(), free_index_.end(), std::greater<std::pair<size_t, size_t>>());
 }
 
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+size_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::takeCF() {
+    while (!free_index_.empty()) {
+        std::pop_heap(free_index_.begin(), free_index_.end(), std::greater<std::pair<size_t, size_t>>());
+        std::pair<size_t, size_t> entry = free_index_.back();
+        free_index_.pop_back();
+
+        size_t position = entry.second;
+        if (position == active_ || filters_[position]->is_full) {
+            continue;
+        }
+        if (filters_[position]->element_count > entry.first) {
+            // filter got fuller since it was indexed, it is put back with current count
+            indexCF(position);
+            continue;
+        }
+        return position;
+    }
+    return growCF();
+}
 
 template<typename element_type,
         size_t entries_per_bucket,
         size_t bits_per_fp,
         typename fp_type>
-void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
-storeVictim(Victim &victim, CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf) {
-    if (!cf->insertElement(victim.fp, victim.index, victim)){
-        CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* next_cf = nextCF(cf);
-        storeVictim(victim, next_cf);
+size_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+victimCF(size_t position, const std::vector<size_t> &tried) {
+    if (!geometric_) {
+        return takeCF();
+    }
+    const size_t level = levels_[position];
+    for (size_t k = 0; k < filters_.size(); k++) {
+        if (levels_[k] == level && k != active_ && !filters_[k]->is_full
+            && std::find(tried.begin(), tried.end(), k) == tried.end()) {
+            return k;
+        }
     }
+    return growCF(level);
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::trimGroups() {
+    while (filters_.size() > group_size_) {
+        const size_t first = (filters_.size() - 1) / group_size_ * group_size_;
+        for (size_t k = first; k < filters_.size(); k++) {
+            if (!filters_[k]->is_empty) {
+                return;
+            }
+        }
+
+        levelArena(0)->release(tables_[first]);
+        reclaimed_bytes += levelArena(0)->getTableBytes();
+        for (size_t k = first; k < filters_.size(); k++) {
+            delete filters_[k];
+        }
+        filters_.resize(first);
+        tables_.resize(first);
+        levels_.resize(first);
+        cf_count = filters_.size();
+        if (active_ >= filters_.size()) {
+            active_ = filters_.size() - 1;
+        }
+        rebuildIndex();
+    }
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+inline long DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+probeGroups(size_t i1, size_t i2, uint32_t fp, size_t first, size_t last) const {
+    typedef CuckooTable<fp_type, entries_per_bucket, bits_per_fp> table_type;
+    const size_t count = tables_.size();
+    const uint8_t* const* tables = tables_.data();
+
+    if (group_size_ > 1) {
+        // row of group is addressed as bucket of table with group_size_ times larger buckets
+        const size_t groups = last;
+        const size_t r1 = i1 * group_size_, r2 = i2 * group_size_;
+        for (size_t q = first; q < groups && q < first + DCF_PREFETCH_DISTANCE; q++) {
+            table_type::prefetchBuckets(tables[q * group_size_], r1, r2);
+        }
+        for (size_t q = first; q < groups; q++) {
+            if (q + DCF_PREFETCH_DISTANCE < groups) {
+                table_type::prefetchBuckets(tables[(q + DCF_PREFETCH_DISTANCE) * group_size_], r1, r2);
+            }
+            const uint8_t* group = tables[q * group_size_];
+            const size_t members = std::min(group_size_, count - q * group_size_);
+            long k = table_type::findInRows(group + r1 * table_type::bucketBytes(1),
+                                            group + r2 * table_type::bucketBytes(1), members, fp);
+            if (k >= 0) {
+                return q * group_size_ + k;
+            }
+        }
+        return -1;
+    }
+
+    for (size_t k = first; k < last && k < first + DCF_PREFETCH_DISTANCE; k++) {
+        table_type::prefetchBuckets(tables[k], i1, i2);
+    }
+    for (size_t k = first; k < last; k++) {
+        if (k + DCF_PREFETCH_DISTANCE < last) {
+            table_type::prefetchBuckets(tables[k + DCF_PREFETCH_DISTANCE], i1, i2);
+        }
+        if (table_type::containsFingerprint(tables[k], i1, i2, fp)) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+long DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+findFingerprint(size_t i1, size_t i2, uint32_t fp) const {
+    const size_t groups = (tables_.size() + group_size_ - 1) / group_size_;
+    if (!pool_ || parallel_lookup_filters_ == 0 || tables_.size() < parallel_lookup_filters_) {
+        return probeGroups(i1, i2, fp, 0, groups);
+    }
+
+    const size_t groups_per_task = std::max((size_t) 1, (size_t) DCF_PARALLEL_CHUNK / group_size_);
+    const size_t tasks = (groups + groups_per_task - 1) / groups_per_task;
+    std::atomic<long> found(-1);
+    pool_->run(tasks, [&](size_t t) {
+        if (found.load(std::memory_order_relaxed) >= 0) {
+            return;
+        }
+        const size_t first = t * groups_per_task;
+        long position = probeGroups(i1, i2, fp, first, std::min(groups, first + groups_per_task));
+        if (position >= 0) {
+            found.store(position, std::memory_order_relaxed);
+        }
+    });
+    return found.load(std::memory_order_relaxed);
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+long DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+findElement(uint64_t hash_value, bool single_level) const {
+    typedef CuckooTable<fp_type, entries_per_bucket, bits_per_fp> table_type;
+    // number of filters is logarithmic, so they are probed one by one
+    long found = -1;
+    for (size_t k = 0; k < tables_.size(); k++) {
+        size_t i1, i2;
+        uint32_t fp;
+        levelPass(hash_value, levels_[k], &fp, &i1, &i2);
+        if (table_type::containsFingerprint(tables_[k], i1, i2, fp)) {
+            if (!single_level) {
+                return k;
+            }
+            if (found >= 0 && levels_[k] != levels_[found]) {
+                // element is stored on one of the levels, the other match belongs to another element
+                return DCF_SEVERAL_LEVELS;
+            }
+            found = k;
+        }
+    }
+    return found;
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+size_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+nextCF(size_t position) {
+    for (size_t k = position + 1; k < filters_.size(); k++) {
+        if (!filters_[k]->is_full) {
+            return k;
+        }
+    }
+    return growCF();
+}
+
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+size_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+storeVictim(Victim &victim, size_t position) {
+    // filters which failed are indexed again only after victim is stored, so that they are not retried
+    std::vector<size_t> failed;
+    while (!filters_[position]->insertElement(victim.fp, victim.index, victim)) {
+        failed.push_back(position);
+        position = victimCF(position, failed);
+    }
+
+    // with geometric growth filters are not taken out of index for victims
+    for (size_t k = 0; k < failed.size() && !geometric_; k++) {
+        if (failed[k] != active_ && !filters_[failed[k]]->is_full) {
+            indexCF(failed[k]);
+        }
+    }
+    return position;
 }
 
 
@@ -348,19 +985,26 @@ insertElement(const element_type &element) {
     size_t index;
     uint32_t fp;
 
-    firstPass(element, &fp, &index);
-
-    if (active_cf_->is_full) {
-        active_cf_ = nextCF(active_cf_);
+    if (filters_[active_]->is_full) {
+        active_ = takeCF();
     }
 
-    if (active_cf_->insertElement(fp, index, victim_)) {
-        this->element_count++;
+    if (geometric_) {
+        size_t i2;
+        levelPass(hash_function_->hash(element), levels_[active_], &fp, &index, &i2);
+    } else {
+        firstPass(element, &fp, &index);
     }
-    else {
-        storeVictim(victim_, head_cf_);
-        this->element_count++;
+
+    if (!filters_[active_]->insertElement(fp, index, victim_)) {
+        // active filter is too crowded for further insertions, the one which stored the victim takes its place
+        size_t crowded = active_;
+        active_ = storeVictim(victim_, victimCF(crowded, std::vector<size_t>(1, crowded)));
+        if (!filters_[crowded]->is_full) {
+            indexCF(crowded);
+        }
     }
+    this->element_count++;
 
     return true;
 }
@@ -375,44 +1019,79 @@ containsElement(const element_type &element) {
     size_t i1, i2;
     uint32_t fp;
 
+    if (geometric_) {
+        return findElement(hash_function_->hash(element)) >= 0;
+    }
     firstPass(element, &fp, &i1);
     i2 = indexComplement(i1, fp);
 
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf = head_cf_;
-    while (cf) {
-        if (cf->containsElement(i1, i2, fp)) {
-            return true;
-        }
-        else {
-            cf = cf->next;
+    return findFingerprint(i1, i2, fp) >= 0;
+}
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+containsElements(const element_type* elements, size_t count, bool* out) {
+    const size_t groups = (tables_.size() + group_size_ - 1) / group_size_;
+    auto lookup = [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            if (geometric_) {
+                out[k] = findElement(hash_function_->hash(elements[k])) >= 0;
+                continue;
+            }
+            size_t i1;
+            uint32_t fp;
+            firstPass(elements[k], &fp, &i1);
+            out[k] = probeGroups(i1, indexComplement(i1, fp), fp, 0, groups) >= 0;
         }
+    };
+
+    if (!pool_) {
+        lookup(0, count);
+        return;
     }
-    return false;
+    pool_->run((count + DCF_PARALLEL_BATCH - 1) / DCF_PARALLEL_BATCH, [&](size_t t) {
+        lookup(t * DCF_PARALLEL_BATCH, std::min(count, (t + 1) * DCF_PARALLEL_BATCH));
+    });
 }
 
 template<typename element_type,
         size_t entries_per_bucket,
         size_t bits_per_fp,
         typename fp_type>
-bool DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+DeletionResult DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
 deleteElement(const element_type &element) {
     size_t i1, i2;
     uint32_t fp;
+    long position;
 
-    firstPass(element, &fp, &i1);
-    i2 = indexComplement(i1, fp);
-
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf = head_cf_;
-    while (cf) {
-        if (cf->deleteElement(i1, i2, fp)){
-            this->element_count--;
-            return true;
+    if (geometric_) {
+        const uint64_t hash_value = hash_function_->hash(element);
+        position = findElement(hash_value, true);
+        if (position == DCF_SEVERAL_LEVELS) {
+            return DeletionResult::AMBIGUOUS;
         }
-        else{
-            cf = cf->next;
+        if (position < 0) {
+            return DeletionResult::ABSENT;
         }
+        levelPass(hash_value, levels_[position], &fp, &i1, &i2);
+    } else {
+        firstPass(element, &fp, &i1);
+        i2 = indexComplement(i1, fp);
+        position = findFingerprint(i1, i2, fp);
+        if (position < 0) {
+            return DeletionResult::ABSENT;
+        }
+    }
+    bool was_full = filters_[position]->is_full;
+    filters_[position]->deleteElement(i1, i2, fp);
+    if (was_full && (size_t) position != active_) {
+        indexCF(position);
     }
-    return false;
+    this->element_count--;
+    return DeletionResult::DELETED;
 }
 
 template<typename element_type,
@@ -421,14 +1100,41 @@ template<typename element_type,
         typename fp_type>
 void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
 removeCF(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf) {
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* prev = cf->prev;
-    if (!prev){
-        this->head_cf_ = cf->next;
+    if (group_size_ > 1) {
+        // filter keeps its place in group and takes later insertions, trailing empty groups are released by compact
+        return;
     }
-    else{
-        prev->next = cf->next;
+
+    size_t position = std::find(filters_.begin(), filters_.end(), cf) - filters_.begin();
+    TableArena* arena = levelArena(levels_[position]);
+    arena->release(tables_[position]);
+    reclaimed_bytes += arena->getTableBytes();
+    delete cf;
+    filters_.erase(filters_.begin() + position);
+    tables_.erase(tables_.begin() + position);
+    levels_.erase(levels_.begin() + position);
+
+    if (active_ > position || active_ == filters_.size()) {
+        active_--;
     }
     this->cf_count--;
+    rebuildIndex();
+}
+
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+size_t DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::compact(){
+    const size_t reclaimed = reclaimed_bytes;
+    compact_queue_.clear();
+    if (pool_) {
+        compactInParallel();
+    } else {
+        while (!compactStep(SIZE_MAX));
+    }
+    return reclaimed_bytes - reclaimed;
 }
 
 
@@ -436,41 +1142,171 @@ template<typename element_type,
         size_t entries_per_bucket,
         size_t bits_per_fp,
         typename fp_type>
-void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::compact(){
-    int sparse_cf_count = 0;
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* cf = head_cf_;
-    while (cf) {
-        if (!cf->is_full) {
-            sparse_cf_count++;
+bool DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+compactStep(size_t max_buckets){
+    if (compact_queue_.empty()) {
+        startCompaction();
+    }
+
+    // every sparse filter moves its elements to denser filters from the densest one, until it gets empty
+    while (compact_source_ + 1 < compact_queue_.size()) {
+        if (max_buckets == 0) {
+            return false;
+        }
+        CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* source = compact_queue_[compact_source_];
+        CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* target = compact_queue_[compact_target_];
+        const size_t table_size = levelTableSize(compact_levels_[compact_source_]);
+
+        size_t stop = compact_bucket_;
+        if (compact_levels_[compact_source_] == compact_levels_[compact_target_]) {
+            size_t last = compact_bucket_ + std::min(max_buckets, table_size - compact_bucket_);
+            stop = source->moveElements(target, compact_bucket_, last);
+        } else {
+            // filters of different levels do not share buckets, target is skipped
+            stop = table_size;
+        }
+        max_buckets -= std::min(max_buckets, stop - compact_bucket_);
+        compact_bucket_ = stop;
+
+        if (source->is_empty) {
+            this->removeCF(source);
+            compact_source_++;
+            compact_target_ = compact_queue_.size() - 1;
+            compact_bucket_ = 0;
+        } else if (compact_bucket_ == table_size || target->is_full) {
+            compact_bucket_ = 0;
+            if (--compact_target_ == compact_source_) {
+                compact_source_++;
+                compact_target_ = compact_queue_.size() - 1;
+            }
         }
-        cf = cf->next;
     }
-    if (sparse_cf_count == 0) return;
 
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>** cfq  =
-            new CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>*[sparse_cf_count];
-    int j = 0;
-    cf = head_cf_;
-    while (cf) {
-        if(!cf->is_full){
-            cfq[j++] = cf;
+    finishCompaction();
+    return true;
+}
+
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::startCompaction(){
+    std::vector<size_t> positions;
+    for (size_t k = 0; k < filters_.size(); k++) {
+        if (!filters_[k]->is_full) {
+            positions.push_back(k);
         }
-        cf = cf->next;
     }
+    if (group_size_ > 1) {
+        // only whole groups can be released, so trailing filters are emptied into leading ones
+        std::reverse(positions.begin(), positions.end());
+    } else {
+        std::sort(positions.begin(), positions.end(), [this](size_t a, size_t b) {
+            if (levels_[a] != levels_[b]) {
+                return levels_[a] < levels_[b];
+            }
+            return filters_[a]->element_count < filters_[b]->element_count;
+        });
+    }
+    compact_levels_.clear();
+    for (size_t k = 0; k < positions.size(); k++) {
+        compact_queue_.push_back(filters_[positions[k]]);
+        compact_levels_.push_back(levels_[positions[k]]);
+    }
+
+    compact_source_ = 0;
+    compact_target_ = compact_queue_.empty() ? 0 : compact_queue_.size() - 1;
+    compact_bucket_ = 0;
+}
+
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::finishCompaction(){
+    compact_queue_.clear();
+    if (group_size_ > 1) {
+        trimGroups();
+    }
+    // occupancy of filters changed
+    rebuildIndex();
+}
+
 
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::compactInParallel(){
+    startCompaction();
+    // queue is sorted by level, filters of every level form one range compacted separately
+    std::vector<size_t> firsts;
+    for (size_t k = 0; k < compact_queue_.size(); k++) {
+        if (k == 0 || compact_levels_[k] != compact_levels_[k - 1]) {
+            firsts.push_back(k);
+        }
+    }
+    firsts.push_back(compact_queue_.size());
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t round = 0; ; round++) {
+        // pairs of round are disjoint, because sources of every level are fewer than its targets
+        pairs.clear();
+        for (size_t l = 0; l + 1 < firsts.size(); l++) {
+            const size_t sources = (firsts[l + 1] - firsts[l]) / 2;
+            const size_t targets = firsts[l + 1] - firsts[l] - sources;
+            for (size_t k = 0; k < sources && round < targets; k++) {
+                pairs.emplace_back(firsts[l] + k, firsts[l] + sources + (k + round) % targets);
+            }
+        }
+        if (pairs.empty()) {
+            break;
+        }
+        pool_->run(pairs.size(), [&](size_t p) {
+            CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* source = compact_queue_[pairs[p].first];
+            CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* target = compact_queue_[pairs[p].second];
+            source->moveElements(target, 0, levelTableSize(compact_levels_[pairs[p].first]));
+        });
+    }
 
-    sort(cfq, sparse_cf_count);
-    for (int i = 0; i < sparse_cf_count-1; i++) {
-        for (int j = sparse_cf_count-1; j > i; j--) {
-            cfq[i]->moveElements(cfq[j]);
-            if (cfq[i]->is_empty) {
-                this->removeCF(cfq[i]);
-                break; // move to next cf
+    for (size_t l = 0; l + 1 < firsts.size(); l++) {
+        for (size_t k = firsts[l]; k < firsts[l] + (firsts[l + 1] - firsts[l]) / 2; k++) {
+            if (compact_queue_[k]->is_empty) {
+                this->removeCF(compact_queue_[k]);
             }
         }
     }
+    finishCompaction();
+}
+
 
-    delete cfq;
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+DynamicCuckooFilter(const FilterFileHeader &header, uint64_t seed) : seeds_(seed) {
+    this->fp_mask_ = (1ULL << bits_per_fp) - 1;
+    this->cf_table_size_ = header.table_size;
+    this->memory_policy_ = MemoryPolicy::CACHE_ALIGNED;
+
+    unsigned __int128 multiply = ((unsigned __int128) header.hash_multiply[1] << 64) | header.hash_multiply[0];
+    unsigned __int128 add = ((unsigned __int128) header.hash_add[1] << 64) | header.hash_add[0];
+    hash_function_ = new HashFunction(multiply, add);
+
+    victim_.index = header.victim_index;
+    victim_.fp = header.victim_fp;
+    group_size_ = header.group_size ? header.group_size : 1;
+    growth_shift_ = header.growth_shift;
+    min_fp_bits_ = header.min_fp_bits ? header.min_fp_bits : bits_per_fp;
+    geometric_ = growth_shift_ > 0 || min_fp_bits_ < bits_per_fp;
+    max_free_tables_ = ARENA_MAX_FREE_TABLES;
+    active_ = header.active_filter;
+    cf_count = 0;
+    element_count = header.element_count;
+    reclaimed_bytes = 0;
 }
 
 
@@ -479,15 +1315,175 @@ template<typename element_type,
         size_t bits_per_fp,
         typename fp_type>
 void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
-sort(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>** cfq, int count){
-    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>* temp;
-    for (int i = 0; i < count-1; i++){
-        for (int j = 0; j < count-1-i; j++){
-            if(cfq[j]->element_count > cfq[j+1]->element_count){
-                temp = cfq[j];
-                cfq[j] = cfq[j+1];
-                cfq[j+1] = temp;
+save(const std::string &path) const {
+    FilterFileHeader header;
+    header.magic = DYNAMIC_FILTER_FILE_MAGIC;
+    header.entries_per_bucket = entries_per_bucket;
+    header.bits_per_fp = bits_per_fp;
+    header.fp_size = sizeof(fp_type);
+    header.element_size = sizeof(element_type);
+
+    unsigned __int128 multiply = hash_function_->getMultiply();
+    unsigned __int128 add = hash_function_->getAdd();
+    header.hash_multiply[0] = (uint64_t) multiply;
+    header.hash_multiply[1] = (uint64_t) (multiply >> 64);
+    header.hash_add[0] = (uint64_t) add;
+    header.hash_add[1] = (uint64_t) (add >> 64);
+
+    header.table_size = cf_table_size_;
+    header.element_count = element_count;
+    header.victim_index = victim_.index;
+    header.victim_fp = victim_.fp;
+    header.bucket_bytes = CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::bucketBytes(cf_table_size_);
+    header.filter_count = filters_.size();
+    header.active_filter = active_;
+    header.group_size = group_size_;
+    header.growth_shift = growth_shift_;
+    header.min_fp_bits = min_fp_bits_;
+
+    // groups of tables start on a page boundary after records and are aligned to cache line,
+    // every group is stored whole together with padding, even if not all its filters exist
+    const size_t records_end = FILTER_FILE_HEADER_SIZE + header.filter_count * sizeof(SubFilterRecord);
+    const size_t first_offset = (records_end + FILTER_FILE_HEADER_SIZE - 1) / FILTER_FILE_HEADER_SIZE
+                                * FILTER_FILE_HEADER_SIZE;
+    const size_t bucket_size = CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::bucketBytes(1);
+
+    // groups are stored one after another, with geometric growth their size depends on level
+    std::vector<size_t> group_offsets;
+    size_t offset = first_offset;
+    for (size_t k = 0; k < filters_.size(); k += group_size_) {
+        size_t group_bytes = group_size_ * CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
+                bucketBytes(levelTableSize(levels_[k]));
+        group_offsets.push_back(offset);
+        offset += (group_bytes + sizeof(uint64_t) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    }
+
+    // file is replaced only when completely written, tables of a loaded filter are mapped from it
+    const std::string temporary = temporaryFilterPath(path);
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Can not open " + path + " for writing");
+    }
+    try {
+        writeFilterHeader(out, header);
+    } catch (...) {
+        remove(temporary.c_str());
+        throw;
+    }
+
+    for (size_t k = 0; k < filters_.size(); k++) {
+        SubFilterRecord record;
+        record.table_offset = group_offsets[k / group_size_] + k % group_size_ * bucket_size;
+        record.element_count = filters_[k]->element_count;
+        record.is_full = filters_[k]->is_full;
+        record.level = levels_[k];
+        out.write((const char*) &record, sizeof(record));
+    }
+
+    static const char zeros[FILTER_FILE_HEADER_SIZE] = {0};
+    out.write(zeros, first_offset - records_end);
+    for (size_t k = 0; k < filters_.size(); k += group_size_) {
+        size_t group_bytes = group_size_ * CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
+                bucketBytes(levelTableSize(levels_[k]));
+        size_t end = k / group_size_ + 1 < group_offsets.size() ? group_offsets[k / group_size_ + 1] : offset;
+        out.write((const char*) tables_[k], group_bytes);
+        out.write(zeros, end - group_offsets[k / group_size_] - group_bytes);
+    }
+    commitFilterFile(out, temporary, path);
+}
+
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>*
+DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+load(const std::string &path, uint64_t seed) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Can not open " + path + " for reading");
+    }
+    FilterFileHeader header = readFilterHeader(in, DYNAMIC_FILTER_FILE_MAGIC);
+    checkFilterHeader(header, entries_per_bucket, bits_per_fp, sizeof(fp_type), sizeof(element_type));
+    if (header.filter_count == 0 || header.active_filter >= header.filter_count) {
+        throw std::runtime_error("Filter file has inconsistent list of filters");
+    }
+    if (header.growth_shift > 30 || header.min_fp_bits > bits_per_fp
+        || header.bucket_bytes != CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::bucketBytes(header.table_size)) {
+        throw std::runtime_error("Filter file has inconsistent table size");
+    }
+
+    SubFilterRecord* records = new SubFilterRecord[header.filter_count];
+    in.read((char*) records, header.filter_count * sizeof(SubFilterRecord));
+    if (!in) {
+        delete[] records;
+        throw std::runtime_error("File is too short for list of filters");
+    }
+
+    DynamicCuckooFilter* dcf = new DynamicCuckooFilter(header, seed);
+    try {
+        // whole groups of interleaved tables are mapped
+        const size_t bucket_size = CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::bucketBytes(1);
+        size_t mapped_size = 0;
+        for (size_t k = 0; k < header.filter_count; k++) {
+            if (records[k].level > 0 && !dcf->geometric_) {
+                throw std::runtime_error("Filter file has levels of filters without geometric growth");
             }
+            size_t group_bytes = dcf->group_size_ * CuckooTable<fp_type, entries_per_bucket, bits_per_fp>::
+                    bucketBytes(dcf->levelTableSize(records[k].level));
+            size_t group_end = records[k].table_offset - k % dcf->group_size_ * bucket_size
+                               + group_bytes + sizeof(uint64_t);
+            mapped_size = std::max(mapped_size, group_end);
+        }
+
+        dcf->mapping_ = mapFile(path.c_str(), 0, mapped_size, true);
+        for (size_t k = 0; k < header.filter_count; k++) {
+            // filters saved beyond the last level have its table size and fingerprint bits
+            dcf->addCF(dcf->mapping_.data + records[k].table_offset, records[k].element_count,
+                       records[k].is_full, std::min((size_t) records[k].level, dcf->lastLevel()));
         }
+        dcf->rebuildIndex();
+    } catch (...) {
+        delete[] records;
+        delete dcf;
+        throw;
+    }
+
+    delete[] records;
+    return dcf;
+}
+
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+enableParallelism(size_t threads) {
+    delete pool_;
+    pool_ = threads > 1 ? new ThreadPool(threads - 1) : nullptr;
+}
+
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+enableParallelLookups(size_t min_filters) {
+    parallel_lookup_filters_ = min_filters;
+}
+
+
+template<typename element_type,
+        size_t entries_per_bucket,
+        size_t bits_per_fp,
+        typename fp_type>
+void DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>::
+setMaxFreeTables(size_t tables) {
+    max_free_tables_ = tables;
+    for (size_t level = 0; level < arenas_.size(); level++) {
+        arenas_[level]->setMaxFreeTables(tables);
     }
-}
\ No newline at end of file
+}
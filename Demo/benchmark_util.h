@@ -0,0 +1,28 @@
+#ifndef CUCKOOFILTER_BENCHMARK_UTIL_H
+#define CUCKOOFILTER_BENCHMARK_UTIL_H
+
+#include <chrono>
+#include <stdint.h>
+
+/**
+ * Bijective mixing of 32-bit integers (MurmurHash3 finalizer). Filter hash is linear in the key, so
+ * consecutive keys would be spread over the table too regularly for realistic measurements.
+ */
+static inline uint32_t scramble(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x85ebca6b;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * Returns milliseconds elapsed since begin.
+ */
+static inline double elapsed(std::chrono::steady_clock::time_point begin) {
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1e3;
+}
+
+#endif
@@ -0,0 +1,107 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../CF/cuckoo_filter.h"
+#include "../CF/blocked_cuckoo_filter.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+static const size_t entries_per_bucket = 4;
+// strings are hashed with CityHash, integer keys would go through linear multiply-shift hash
+// and distort false positive rate
+typedef std::string element_type;
+
+
+template<typename filter_type>
+double lookup(filter_type *filter, std::vector<element_type> &queries, size_t *found) {
+    size_t count = 0;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); i++) {
+        count += filter->containsElement(queries[i]);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    *found = count;
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+}
+
+
+/**
+ * Filling the filter up to given load and measuring lookup throughput of positive and negative queries,
+ * then filling it until the first failed insertion and measuring maximal load and false positive rate.
+ */
+template<typename filter_type>
+void runBenchmark(const std::string &name, filter_type *filter, double load, size_t num_queries) {
+    size_t slots = filter->getTableSize() * entries_per_bucket;
+    size_t target = (size_t) (load * slots);
+
+    size_t inserted = 0;
+    for (; inserted < target; inserted++) {
+        element_type element = std::to_string(inserted);
+        if (!filter->insertElement(element)) break;
+    }
+
+    std::vector<element_type> positive(num_queries);
+    std::vector<element_type> negative(num_queries);
+    for (size_t i = 0; i < num_queries; i++) {
+        positive[i] = std::to_string((i * 2654435761ULL) % inserted);
+        negative[i] = "n" + std::to_string(i);
+    }
+
+    size_t found;
+    double pos_time = lookup(filter, positive, &found);
+    assert(found == num_queries);
+    double neg_time = lookup(filter, negative, &found);
+
+    while (true) {
+        element_type element = std::to_string(inserted);
+        if (!filter->insertElement(element)) break;
+        inserted++;
+    }
+
+    size_t false_positives;
+    lookup(filter, negative, &false_positives);
+
+    std::cout << name << std::endl;
+    std::cout << "  Positive lookup at " << 100 * load << "% load [Mops/s]: " << num_queries / pos_time << std::endl;
+    std::cout << "  Negative lookup at " << 100 * load << "% load [Mops/s]: " << num_queries / neg_time << std::endl;
+    std::cout << "  Max load factor [%]: " << 100. * inserted / slots << std::endl;
+    std::cout << "  False positive rate at max load [%]: " << 100. * false_positives / num_queries << std::endl;
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("BlockedFilterBenchmark", "Blocked cuckoo filter compared to cuckoo filter");
+    options.add_options()
+            ("s,buckets", "Table size in buckets", cxxopts::value<double>()->default_value("1e7"))
+            ("l,load", "Load factor for lookup measurements", cxxopts::value<double>()->default_value("0.7"))
+            ("q,queries", "Number of positive and of negative lookups", cxxopts::value<double>()->default_value("1e7"));
+    auto result = options.parse(argc, argv);
+
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+    double load = result["load"].as<double>();
+    size_t num_queries = (size_t) result["queries"].as<double>();
+
+    // constructor rounds table size down to power of two, pass double size to get at least given size
+    {
+        CuckooFilter<element_type, entries_per_bucket, 16, uint16_t> filter(2 * buckets);
+        std::cout << "Buckets: " << filter.getTableSize() << std::endl;
+        runBenchmark("CuckooFilter, 16-bit fingerprints", &filter, load, num_queries);
+    }
+    {
+        BlockedCuckooFilter<element_type, entries_per_bucket, 16, uint16_t> filter(2 * buckets);
+        runBenchmark("BlockedCuckooFilter, 16-bit fingerprints", &filter, load, num_queries);
+        std::cout << "  Overflowed fingerprints: " << filter.getOverflowSize() << std::endl;
+    }
+    {
+        CuckooFilter<element_type, entries_per_bucket, 8, uint8_t> filter(2 * buckets);
+        runBenchmark("CuckooFilter, 8-bit fingerprints", &filter, load, num_queries);
+    }
+    {
+        BlockedCuckooFilter<element_type, entries_per_bucket, 8, uint8_t> filter(2 * buckets);
+        runBenchmark("BlockedCuckooFilter, 8-bit fingerprints", &filter, load, num_queries);
+        std::cout << "  Overflowed fingerprints: " << filter.getOverflowSize() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../CF/cuckoo_filter.h"
+#include "benchmark_util.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+typedef CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter_type;
+
+
+size_t countContained(filter_type &filter, std::vector<element_type> &elements) {
+    size_t found = 0;
+    for (size_t i = 0; i < elements.size(); i++) {
+        found += filter.containsElement(elements[i]);
+    }
+    return found;
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("BulkLoadBenchmark", "Bulk load versus element-wise insertion of Cuckoo filter");
+    options.add_options()
+            ("s,buckets", "Table size in buckets", cxxopts::value<double>()->default_value("1e8"))
+            ("l,load", "Load factor of built filter", cxxopts::value<double>()->default_value("0.9"));
+    auto result = options.parse(argc, argv);
+
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+    double load = result["load"].as<double>();
+
+    // constructor rounds table size down to power of two, pass double size to get at least given size
+    size_t table_size = highestPowerOfTwo(2 * buckets);
+    std::vector<element_type> elements((size_t) (load * table_size * entries_per_bucket));
+    for (size_t i = 0; i < elements.size(); i++) {
+        elements[i] = scramble((uint32_t) i);
+    }
+    std::cout << "Buckets: " << table_size << ", elements: " << elements.size() << std::endl;
+
+    double insert_time, bulk_time;
+    {
+        filter_type filter(2 * buckets);
+        size_t inserted = 0;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < elements.size() && filter.insertElement(elements[i]); i++) {
+            inserted++;
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        insert_time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+        std::cout << "insertElement [Mops/s]: " << inserted / insert_time
+                  << ", inserted: " << inserted << std::endl;
+    }
+    {
+        filter_type filter(2 * buckets);
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        size_t loaded = filter.bulkLoad(elements.begin(), elements.end());
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        bulk_time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+        std::cout << "bulkLoad [Mops/s]: " << elements.size() / bulk_time
+                  << ", inserted: " << loaded
+                  << ", contained: " << countContained(filter, elements) << std::endl;
+    }
+    std::cout << "Speedup: " << insert_time / bulk_time << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../CF/cuckoo_filter.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+double scalarLookup(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> *filter,
+                    std::vector<element_type> &queries, size_t *positives) {
+    size_t found = 0;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); i++) {
+        found += filter->containsElement(queries[i]);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    *positives = found;
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+}
+
+
+template<typename element_type, size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+double batchedLookup(CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> *filter,
+                     std::vector<element_type> &queries, size_t batch_size, size_t *positives) {
+    size_t found = 0;
+    bool *out = new bool[batch_size];
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t start = 0; start < queries.size(); start += batch_size) {
+        size_t count = std::min(batch_size, queries.size() - start);
+        filter->containsElements(queries.data() + start, count, out);
+        for (size_t k = 0; k < count; k++) {
+            found += out[k];
+        }
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    delete[] out;
+    *positives = found;
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("BatchLookupBenchmark", "Batched versus scalar lookup throughput of Cuckoo filter");
+    options.add_options()
+            ("min_buckets", "Smallest table size in buckets", cxxopts::value<double>()->default_value("1e5"))
+            ("max_buckets", "Largest table size in buckets", cxxopts::value<double>()->default_value("1e9"))
+            ("l,load", "Load factor of table before lookups", cxxopts::value<double>()->default_value("0.5"))
+            ("q,queries", "Number of lookups, half of them positive", cxxopts::value<double>()->default_value("1e7"))
+            ("b,batch", "Number of elements per containsElements call", cxxopts::value<int>()->default_value("4096"))
+            ("p,pages", "Table memory: aligned, thp (transparent huge pages) or hugetlb (explicit huge pages)",
+             cxxopts::value<std::string>()->default_value("aligned"))
+            ("s,simd", "Probe kernel of batched lookups: swar, avx2 or avx512 (limited by CPU)",
+             cxxopts::value<std::string>()->default_value("avx512"));
+    auto result = options.parse(argc, argv);
+
+    size_t min_buckets = (size_t) result["min_buckets"].as<double>();
+    size_t max_buckets = (size_t) result["max_buckets"].as<double>();
+    double load = result["load"].as<double>();
+    size_t num_queries = (size_t) result["queries"].as<double>();
+    size_t batch_size = result["batch"].as<int>();
+    std::string pages = result["pages"].as<std::string>();
+    std::string simd = result["simd"].as<std::string>();
+
+    MemoryPolicy policy = MemoryPolicy::CACHE_ALIGNED;
+    if (pages == "thp") {
+        policy = MemoryPolicy::TRANSPARENT_HUGE_PAGES;
+    } else if (pages == "hugetlb") {
+        policy = MemoryPolicy::EXPLICIT_HUGE_PAGES;
+    }
+
+    SimdLevel level = SimdLevel::AVX512;
+    if (simd == "swar") {
+        level = SimdLevel::SWAR;
+    } else if (simd == "avx2") {
+        level = SimdLevel::AVX2;
+    }
+    std::cout << "Batched probe: " << simdLevelName(setSimdLevel(level)) << std::endl;
+
+    std::cout << "Buckets\t\tInserted\tScalar [Mops/s]\tBatched [Mops/s]\tSpeedup" << std::endl;
+
+    for (size_t buckets = min_buckets; buckets <= max_buckets; buckets *= 10) {
+        // constructor rounds table size down to power of two, pass double size to get at least given size
+        CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter(2 * buckets, policy);
+        size_t num_elements = (size_t) (load * filter.getTableSize() * entries_per_bucket);
+
+        size_t inserted = 0;
+        for (element_type i = 0; i < num_elements; i++, inserted++) {
+            if (!filter.insertElement(i)) {
+                break;
+            }
+        }
+
+        // positive and negative queries interleaved
+        std::vector<element_type> queries(num_queries);
+        for (size_t i = 0; i < num_queries; i++) {
+            queries[i] = (i & 1) ? (element_type) (inserted + i) : (element_type) ((i * 2654435761ULL) % inserted);
+        }
+
+        size_t scalar_positives, batched_positives;
+        double scalar_time = scalarLookup(&filter, queries, &scalar_positives);
+        double batched_time = batchedLookup(&filter, queries, batch_size, &batched_positives);
+        assert(scalar_positives == batched_positives);
+
+        std::cout << filter.getTableSize() << "\t\t"
+                  << inserted << "\t\t"
+                  << num_queries / scalar_time << "\t\t"
+                  << num_queries / batched_time << "\t\t\t"
+                  << scalar_time / batched_time << std::endl;
+    }
+
+    return 0;
+}
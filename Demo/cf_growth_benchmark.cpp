@@ -0,0 +1,81 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../CF/cuckoo_filter.h"
+#include "benchmark_util.h"
+#include <chrono>
+#include <iostream>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+typedef CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter_type;
+
+
+/**
+ * Inserts elements from given one until filter gets full and returns the first element which was not inserted.
+ * The last inserted element may be kept aside as victim.
+ */
+static uint32_t fill(filter_type &filter, uint32_t first) {
+    uint32_t i = first;
+    element_type element = scramble(i);
+    while (filter.insertElement(element)) {
+        element = scramble(++i);
+    }
+    return i;
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("FilterGrowthBenchmark", "Doubling of Cuckoo filter by grow versus rebuilding it");
+    options.add_options()
+            ("s,buckets", "Initial table size in buckets", cxxopts::value<double>()->default_value("1e5"))
+            ("g,growths", "Number of growths", cxxopts::value<int>()->default_value("6"))
+            ("q,queries", "Number of negative lookups measuring false positive rate",
+             cxxopts::value<double>()->default_value("1e6"));
+    auto result = options.parse(argc, argv);
+
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+    size_t growths = result["growths"].as<int>();
+    size_t queries = (size_t) result["queries"].as<double>();
+
+    filter_type filter(2 * buckets);
+    uint32_t stored = fill(filter, 0);
+
+    std::cout << "Buckets\t\tElements\tGrow [ms]\tRebuild [ms]\tLoad after refill\tFalse negatives\tFP rate"
+              << std::endl;
+    for (size_t round = 0; round < growths; round++) {
+        // victim of the full filter is placed by grow
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        filter.grow();
+        double grow_time = elapsed(begin);
+
+        // without grow, larger filter has to be built from all elements again
+        begin = std::chrono::steady_clock::now();
+        {
+            filter_type rebuilt(2 * filter.getTableSize());
+            for (uint32_t i = 0; i < stored; i++) {
+                element_type element = scramble(i);
+                rebuilt.insertElement(element);
+            }
+        }
+        double rebuild_time = elapsed(begin);
+
+        stored = fill(filter, stored);
+
+        size_t missed = 0, found = 0;
+        for (uint32_t i = 0; i < stored; i++) {
+            element_type element = scramble(i);
+            missed += !filter.containsElement(element);
+        }
+        for (uint32_t i = 0; i < queries; i++) {
+            element_type element = scramble(stored + i);
+            found += filter.containsElement(element);
+        }
+        std::cout << filter.getTableSize() << "\t\t" << stored << "\t\t" << grow_time << "\t\t" << rebuild_time
+                  << "\t\t" << stored / (double) (entries_per_bucket * filter.getTableSize()) << "\t\t\t"
+                  << missed << "\t\t" << found / (double) queries << std::endl;
+    }
+
+    return 0;
+}
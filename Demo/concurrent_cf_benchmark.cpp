@@ -0,0 +1,119 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../CF/cuckoo_filter.h"
+#include "../CF/concurrent_cuckoo_filter.h"
+#include "benchmark_util.h"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+
+
+/**
+ * Cuckoo filter shared by threads under one global mutex, which is the baseline for concurrent filter.
+ */
+class LockedCuckooFilter {
+private:
+    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter;
+    std::mutex mutex;
+
+public:
+    explicit LockedCuckooFilter(uint32_t max_table_size) : filter(max_table_size) {}
+
+    bool insertElement(element_type element) {
+        std::lock_guard<std::mutex> guard(mutex);
+        return filter.insertElement(element);
+    }
+
+    bool containsElement(element_type element) {
+        std::lock_guard<std::mutex> guard(mutex);
+        return filter.containsElement(element);
+    }
+
+    size_t getTableSize() {
+        return filter.getTableSize();
+    }
+};
+
+
+/**
+ * Runs work(thread_id, thread_count) in given number of threads and returns wall time in microseconds.
+ */
+double runThreads(size_t thread_count, const std::function<void(size_t, size_t)> &work) {
+    std::vector<std::thread> threads;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < thread_count; t++) {
+        threads.emplace_back(work, t, thread_count);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+}
+
+
+/**
+ * Measures insertion throughput of threads filling empty filter to given load, each thread inserting
+ * its own part of keys, then lookup throughput of threads querying the filled filter, half of queries positive.
+ */
+template<typename filter_type>
+void runBenchmark(const std::string &name, uint32_t buckets, double load, size_t queries, size_t max_threads) {
+    std::cout << name << std::endl;
+    std::cout << "Threads\tInsert [Mops/s]\tLookup [Mops/s]" << std::endl;
+
+    for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+        filter_type filter(2 * buckets);
+        size_t num_elements = (size_t) (load * filter.getTableSize() * entries_per_bucket);
+
+        double insert_time = runThreads(thread_count, [&](size_t t, size_t n) {
+            for (size_t i = t; i < num_elements; i += n) {
+                filter.insertElement(scramble((uint32_t) i));
+            }
+        });
+
+        double lookup_time = runThreads(thread_count, [&](size_t t, size_t n) {
+            size_t found = 0;
+            for (size_t i = t; i < queries; i += n) {
+                element_type element = (i & 1) ? scramble((uint32_t) (num_elements + i))
+                                               : scramble((uint32_t) ((i * 2654435761ULL) % num_elements));
+                found += filter.containsElement(element);
+            }
+            volatile size_t sink = found;
+            (void) sink;
+        });
+
+        std::cout << thread_count << "\t" << num_elements / insert_time << "\t\t"
+                  << queries / lookup_time << std::endl;
+    }
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("ConcurrentFilterBenchmark", "Concurrent Cuckoo filter versus filter under global mutex");
+    options.add_options()
+            ("s,buckets", "Table size in buckets", cxxopts::value<double>()->default_value("1e7"))
+            ("l,load", "Load factor after insertions", cxxopts::value<double>()->default_value("0.9"))
+            ("q,queries", "Total number of lookups", cxxopts::value<double>()->default_value("1e8"))
+            ("t,threads", "Maximal number of threads, doubled from 1",
+             cxxopts::value<int>()->default_value(std::to_string(std::thread::hardware_concurrency())));
+    auto result = options.parse(argc, argv);
+
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+    double load = result["load"].as<double>();
+    size_t queries = (size_t) result["queries"].as<double>();
+    size_t max_threads = result["threads"].as<int>();
+
+    runBenchmark<ConcurrentCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type>>
+            ("ConcurrentCuckooFilter", buckets, load, queries, max_threads);
+    runBenchmark<LockedCuckooFilter>("CuckooFilter with global mutex", buckets, load, queries, max_threads);
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../DCF/dynamic_cuckoo_filter.h"
+#include "benchmark_util.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+typedef DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter_type;
+
+
+/**
+ * Element i is deleted if its scrambled value falls below given fraction of the 32-bit range.
+ */
+static inline bool isDeleted(uint32_t i, double deleted) {
+    return scramble(i ^ 0x9e3779b9) < deleted * 4294967296.0;
+}
+
+
+/**
+ * Fills filter with given number of filters, deletes a fraction of elements and compacts it either
+ * at once (step_buckets == 0) or in steps of step_buckets buckets. Prints total time, the longest
+ * pause, number of filters before and after compaction, reclaimed memory and false negatives.
+ */
+void measureCompaction(const char *mode, uint32_t buckets, size_t filters, double deleted, size_t step_buckets,
+                       size_t threads) {
+    filter_type filter(2 * buckets);
+    filter.enableParallelism(threads);
+    size_t stored = (size_t) (0.9 * filter.getTableSize() * entries_per_bucket) * filters;
+    for (size_t i = 0; i < stored; i++) {
+        filter.insertElement(scramble((uint32_t) i));
+    }
+    for (size_t i = 0; i < stored; i++) {
+        if (isDeleted((uint32_t) i, deleted)) {
+            filter.deleteElement(scramble((uint32_t) i));
+        }
+    }
+    size_t before = filter.cf_count;
+
+    double total_time = 0, max_pause = 0;
+    if (step_buckets == 0) {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        filter.compact();
+        total_time = max_pause = elapsed(begin);
+    } else {
+        bool finished = false;
+        while (!finished) {
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            finished = filter.compactStep(step_buckets);
+            double pause = elapsed(begin);
+            total_time += pause;
+            max_pause = std::max(max_pause, pause);
+        }
+    }
+
+    size_t missed = 0;
+    for (size_t i = 0; i < stored; i++) {
+        if (!isDeleted((uint32_t) i, deleted)) {
+            missed += !filter.containsElement(scramble((uint32_t) i));
+        }
+    }
+
+    std::cout << mode << "\t" << total_time << "\t\t" << max_pause << "\t\t" << before << "\t" << filter.cf_count
+              << "\t" << filter.reclaimed_bytes / 1048576.0 << "\t\t" << missed << std::endl;
+}
+
+
+/**
+ * Returns resident memory of the process in megabytes.
+ */
+static double residentMegabytes() {
+    size_t size = 0, resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> size >> resident;
+    return resident * (double) sysconf(_SC_PAGESIZE) / 1048576.0;
+}
+
+
+/**
+ * Alternates bursts of insertions and deletions: every cycle inserts given number of filters worth of
+ * elements, deletes elements left from the previous cycle and a fraction of new ones, and compacts
+ * the filter in steps. Prints number of filters and resident memory after every cycle.
+ */
+void measureBursts(uint32_t buckets, size_t filters, double deleted, size_t step_buckets, size_t cycles,
+                   size_t free_tables) {
+    filter_type filter(2 * buckets);
+    filter.setMaxFreeTables(free_tables);
+    size_t burst = (size_t) (0.9 * filter.getTableSize() * entries_per_bucket) * filters;
+
+    std::cout << "Cycle\tPeak filters\tFilters\tResident [MB]\tReclaimed [MB]" << std::endl;
+    for (size_t cycle = 0; cycle < cycles; cycle++) {
+        uint32_t first = (uint32_t) (cycle * burst);
+        for (size_t i = 0; i < burst; i++) {
+            filter.insertElement(scramble(first + (uint32_t) i));
+        }
+        size_t peak = filter.cf_count;
+
+        if (cycle > 0) {
+            for (uint32_t i = first - (uint32_t) burst; i < first; i++) {
+                if (!isDeleted(i, deleted)) {
+                    filter.deleteElement(scramble(i));
+                }
+            }
+        }
+        for (uint32_t i = first; i < first + (uint32_t) burst; i++) {
+            if (isDeleted(i, deleted)) {
+                filter.deleteElement(scramble(i));
+            }
+        }
+        while (!filter.compactStep(step_buckets));
+
+        std::cout << cycle << "\t" << peak << "\t\t" << filter.cf_count << "\t" << residentMegabytes() << "\t\t"
+                  << filter.reclaimed_bytes / 1048576.0 << std::endl;
+    }
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("DynamicFilterCompactionBenchmark", "Compaction of dynamic Cuckoo filter after deletions");
+    options.add_options()
+            ("s,buckets", "Table size of single filter in buckets", cxxopts::value<double>()->default_value("1e6"))
+            ("f,filters", "Number of filters filled before deletions", cxxopts::value<int>()->default_value("16"))
+            ("d,deleted", "Fraction of deleted elements", cxxopts::value<double>()->default_value("0.7"))
+            ("b,step", "Number of buckets moved by one incremental step", cxxopts::value<double>()->default_value("1e4"))
+            ("t,threads", "Number of threads of parallel compaction", cxxopts::value<int>()->default_value("4"))
+            ("c,cycles", "Number of cycles of insertions and deletions", cxxopts::value<int>()->default_value("6"))
+            ("p,free_tables", "Number of released tables kept resident",
+             cxxopts::value<int>()->default_value(std::to_string(ARENA_MAX_FREE_TABLES)));
+    auto result = options.parse(argc, argv);
+
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+    size_t filters = result["filters"].as<int>();
+    double deleted = result["deleted"].as<double>();
+    size_t step_buckets = (size_t) result["step"].as<double>();
+    size_t threads = result["threads"].as<int>();
+    size_t cycles = result["cycles"].as<int>();
+    size_t free_tables = result["free_tables"].as<int>();
+
+    std::cout << "Mode\tTotal [ms]\tMax pause [ms]\tBefore\tAfter\tReclaimed [MB]\tFalse negatives" << std::endl;
+    measureCompaction("full", buckets, filters, deleted, 0, 1);
+    measureCompaction("steps", buckets, filters, deleted, step_buckets, 1);
+    measureCompaction("parallel", buckets, filters, deleted, 0, threads);
+
+    std::cout << std::endl;
+    measureBursts(buckets, filters, deleted, step_buckets, cycles, free_tables);
+
+    return 0;
+}
@@ -132,9 +132,10 @@ int main(int argc, char **argv) {
         myfile << "--------------------COMPACTION ANALYSIS-----------------" << std::endl;
         size_t before = filter.cf_count;
         myfile << "Number of cuckoo filters before compaction: " << before << std::endl;
-        filter.compact();
+        size_t reclaimed = filter.compact();
         size_t after = filter.cf_count;
         myfile << "Number of cuckoo filters after compaction: " << after << std::endl;
+        myfile << "Memory reclaimed by compaction [B]: " << reclaimed << std::endl;
 
         myfile << std::endl;
         myfile << "--------------------TIME ANALYSIS-----------------------" << std::endl;
@@ -0,0 +1,109 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../DCF/dynamic_cuckoo_filter.h"
+#include "benchmark_util.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+typedef DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter_type;
+
+
+/**
+ * Returns throughput of lookups in millions per second. Positive lookups query stored elements
+ * 0 .. stored - 1, negative lookups query elements never inserted.
+ */
+double measureLookups(filter_type &filter, size_t stored, size_t queries, bool positive, size_t &found) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    found = 0;
+    for (size_t i = 0; i < queries; i++) {
+        uint32_t key = positive ? (uint32_t) ((i * 2654435761ULL) % stored) : (uint32_t) (stored + i);
+        found += filter.containsElement(scramble(key));
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return queries / (double) std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+}
+
+
+/**
+ * Returns throughput of batched positive lookups in millions per second.
+ */
+double measureBatch(filter_type &filter, size_t stored, size_t queries, size_t &found) {
+    std::vector<element_type> elements(queries);
+    for (size_t i = 0; i < queries; i++) {
+        elements[i] = scramble((uint32_t) ((i * 2654435761ULL) % stored));
+    }
+    bool *contained = new bool[queries];
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    filter.containsElements(elements.data(), queries, contained);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    found = 0;
+    for (size_t i = 0; i < queries; i++) {
+        found += contained[i];
+    }
+    delete[] contained;
+    return queries / (double) std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("DynamicFilterLookupBenchmark", "Lookups of dynamic Cuckoo filter growing to many filters");
+    options.add_options()
+            ("s,buckets", "Table size of single filter in buckets", cxxopts::value<double>()->default_value("1e6"))
+            ("f,filters", "Maximal number of filters, doubled from 1", cxxopts::value<int>()->default_value("32"))
+            ("q,queries", "Number of lookups per measurement", cxxopts::value<double>()->default_value("1e6"))
+            ("g,group", "Number of filters with interleaved buckets, 1 for separate tables",
+             cxxopts::value<int>()->default_value("1"))
+            ("t,threads", "Number of threads of batched lookups, 1 for sequential lookups",
+             cxxopts::value<int>()->default_value("1"))
+            ("p,parallel", "Minimal number of filters probed in parallel by single lookups, 0 for sequential ones",
+             cxxopts::value<int>()->default_value("0"))
+            ("r,growth", "Factor by which every new filter is larger, 1 for filters of the same size",
+             cxxopts::value<int>()->default_value("1"))
+            ("m,min_fp_bits", "Fingerprint bits of the first filter, increased by one for every new filter",
+             cxxopts::value<int>()->default_value(std::to_string(bits_per_fp)));
+    auto result = options.parse(argc, argv);
+
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+    size_t max_filters = result["filters"].as<int>();
+    size_t queries = (size_t) result["queries"].as<double>();
+    size_t group_size = result["group"].as<int>();
+    size_t threads = result["threads"].as<int>();
+    size_t parallel_filters = result["parallel"].as<int>();
+    size_t growth_factor = result["growth"].as<int>();
+    size_t min_fp_bits = result["min_fp_bits"].as<int>();
+
+    filter_type filter(2 * buckets, MemoryPolicy::CACHE_ALIGNED, DEFAULT_SEED, group_size, growth_factor, min_fp_bits);
+    filter.enableParallelism(threads);
+    filter.enableParallelLookups(parallel_filters);
+    // filter is regarded as full at 90% load
+    size_t per_filter = (size_t) (0.9 * filter.getTableSize() * entries_per_bucket);
+    size_t stored = 0;
+
+    std::cout << "Filters\tInsert [Mops/s]\tPositive [Mops/s]\tNegative [Mops/s]\tBatch [Mops/s]\tFalse negatives"
+              << "\tFalse positives" << std::endl;
+    for (size_t filters = 1; filters <= max_filters; filters *= 2) {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        size_t inserted = filters * per_filter - stored;
+        for (; stored < filters * per_filter; stored++) {
+            filter.insertElement(scramble((uint32_t) stored));
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double insert = inserted / (double) std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+        size_t found_positive, found_negative, found_batch;
+        double positive = measureLookups(filter, stored, queries, true, found_positive);
+        double negative = measureLookups(filter, stored, queries, false, found_negative);
+        double batch = measureBatch(filter, stored, queries, found_batch);
+        std::cout << filter.cf_count << "\t" << insert << "\t\t" << positive << "\t\t\t" << negative << "\t\t\t" << batch << "\t\t"
+                  << (queries - found_positive) + (queries - found_batch) << "\t\t" << found_negative << std::endl;
+    }
+
+    return 0;
+}
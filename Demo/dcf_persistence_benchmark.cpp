@@ -0,0 +1,71 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../DCF/dynamic_cuckoo_filter.h"
+#include "benchmark_util.h"
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+typedef DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter_type;
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("DynamicFilterPersistenceBenchmark",
+                             "Restart time of dynamic Cuckoo filter loaded from memory-mapped file");
+    options.add_options()
+            ("s,buckets", "Table size of single filter in buckets", cxxopts::value<double>()->default_value("1e5"))
+            ("m,max_elements", "Maximal number of elements, doubled from table capacity",
+             cxxopts::value<double>()->default_value("1e7"))
+            ("q,queries", "Number of lookups after loading", cxxopts::value<double>()->default_value("1e5"))
+            ("f,file", "Path of filter file", cxxopts::value<std::string>()->default_value("filter.dcf"));
+    auto result = options.parse(argc, argv);
+
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+    size_t max_elements = (size_t) result["max_elements"].as<double>();
+    size_t queries = (size_t) result["queries"].as<double>();
+    std::string path = result["file"].as<std::string>();
+
+    std::cout << "Elements\tFilters\tSave [ms]\tLoad [ms]\tLookups [ms]\tFalse negatives" << std::endl;
+    for (size_t elements = buckets * entries_per_bucket; elements <= max_elements; elements *= 2) {
+        size_t cf_count;
+        double save_time;
+        {
+            filter_type filter(2 * buckets);
+            for (size_t i = 0; i < elements; i++) {
+                filter.insertElement(scramble((uint32_t) i));
+            }
+            cf_count = filter.cf_count;
+
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            filter.save(path);
+            save_time = elapsed(begin);
+        }
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        filter_type *filter = filter_type::load(path);
+        double load_time = elapsed(begin);
+
+        begin = std::chrono::steady_clock::now();
+        size_t missed = 0;
+        for (size_t i = 0; i < queries; i++) {
+            missed += !filter->containsElement(scramble((uint32_t) ((i * 2654435761ULL) % elements)));
+        }
+        double lookup_time = elapsed(begin);
+
+        // loaded filter keeps growing, pages are copied on write and file is not modified
+        for (size_t i = elements; i < elements + queries; i++) {
+            filter->insertElement(scramble((uint32_t) i));
+        }
+        delete filter;
+
+        std::cout << elements << "\t" << cf_count << "\t" << save_time << "\t\t" << load_time << "\t\t"
+                  << lookup_time << "\t\t" << missed << std::endl;
+    }
+
+    remove(path.c_str());
+    return 0;
+}
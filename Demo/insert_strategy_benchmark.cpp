@@ -0,0 +1,70 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../CF/cuckoo_filter.h"
+#include "benchmark_util.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+
+
+/**
+ * Inserting elements until the first failure. Insertion throughput is reported separately for every
+ * load interval given by steps, since evictions become expensive only at high load.
+ */
+void runBenchmark(const std::string &name, uint32_t buckets, InsertionStrategy strategy) {
+    const double steps[] = {0.5, 0.8, 0.9, 0.95, 1.0};
+
+    CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter(2 * buckets,
+                                                                                 MemoryPolicy::CACHE_ALIGNED,
+                                                                                 strategy);
+    size_t slots = filter.getTableSize() * entries_per_bucket;
+
+    std::cout << name << std::endl;
+
+    uint32_t inserted = 0;
+    bool full = false;
+    double prev_load = 0;
+    for (double step : steps) {
+        size_t target = (size_t) (step * slots);
+        uint32_t start = inserted;
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        while (inserted < target) {
+            element_type element = scramble(inserted);
+            if (!filter.insertElement(element)) {
+                full = true;
+                break;
+            }
+            inserted++;
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+        std::cout << "  Load " << 100 * prev_load << "-" << 100. * inserted / slots << "% [Mops/s]: "
+                  << (inserted - start) / time << std::endl;
+        prev_load = (double) inserted / slots;
+        if (full) break;
+    }
+
+    std::cout << "  Max load factor [%]: " << 100. * inserted / slots << std::endl;
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("InsertStrategyBenchmark", "Random-walk versus BFS eviction of Cuckoo filter");
+    options.add_options()
+            ("s,buckets", "Table size in buckets", cxxopts::value<double>()->default_value("1e7"));
+    auto result = options.parse(argc, argv);
+
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+
+    runBenchmark("Random walk", buckets, InsertionStrategy::RANDOM_WALK);
+    runBenchmark("BFS", buckets, InsertionStrategy::BFS);
+
+    return 0;
+}
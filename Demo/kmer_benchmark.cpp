@@ -0,0 +1,258 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../CF/cuckoo_filter.h"
+#include "../CF/concurrent_cuckoo_filter.h"
+#include "../FASTA/fasta_reader.h"
+#include "../FASTA/kmer_iterator.h"
+#include "../FASTA/mapped_fasta_reader.h"
+#include "../Utils/random.h"
+#include "../Utils/thread_pool.h"
+#include "benchmark_util.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint16_t fp_type;
+
+
+/**
+ * Writes FASTA file with random genome of given length, split into records of given length
+ * and lines of 80 bases.
+ */
+void generateGenome(const std::string &path, size_t length, size_t record_length) {
+    static const char bases[] = {'A', 'C', 'G', 'T'};
+    FastRandom rng(DEFAULT_SEED);
+    std::ofstream out(path);
+    std::string line;
+    for (size_t position = 0; position < length; position++) {
+        if (position % record_length == 0) {
+            if (!line.empty()) {
+                out << line << '\n';
+                line.clear();
+            }
+            out << ">record_" << position / record_length << " random genome\n";
+        }
+        line += bases[rng.next() & 3];
+        if (line.size() == 80) {
+            out << line << '\n';
+            line.clear();
+        }
+    }
+    if (!line.empty()) {
+        out << line << '\n';
+    }
+}
+
+
+/**
+ * Inserts all k-mers of the file as strings and looks them up again. Prints number of k-mers and throughput
+ * of both passes in millions of k-mers per second, extraction of k-mers is included.
+ */
+void measureStrings(const std::string &path, int k, bool canonical, uint32_t buckets) {
+    CuckooFilter<std::string, entries_per_bucket, bits_per_fp, fp_type> filter(2 * buckets);
+    FastaReader reader(path, k, canonical);
+
+    size_t kmers = 0;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    while (!reader.isDone()) {
+        std::string kmer = reader.nextKMere();
+        filter.insertElement(kmer);
+        kmers++;
+    }
+    double insert_time = elapsed(begin);
+
+    reader.restart();
+    size_t found = 0;
+    begin = std::chrono::steady_clock::now();
+    while (!reader.isDone()) {
+        std::string kmer = reader.nextKMere();
+        found += filter.containsElement(kmer);
+    }
+    double lookup_time = elapsed(begin);
+
+    std::cout << "string\t" << kmers << "\t\t" << kmers / insert_time / 1e3 << "\t\t" << kmers / lookup_time / 1e3
+              << "\t\t" << kmers - found << std::endl;
+}
+
+
+/**
+ * The same as measureStrings with k-mers returned as views into mapped file, no strings are created.
+ */
+void measureViews(const std::string &path, int k, bool canonical, uint32_t buckets) {
+    CuckooFilter<std::string_view, entries_per_bucket, bits_per_fp, fp_type> filter(2 * buckets);
+    MappedFastaReader reader(path, k, canonical);
+
+    size_t kmers = 0;
+    std::string_view kmer;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    while (reader.nextKMere(kmer)) {
+        filter.insertElement(kmer);
+        kmers++;
+    }
+    double insert_time = elapsed(begin);
+
+    reader.restart();
+    size_t found = 0;
+    begin = std::chrono::steady_clock::now();
+    while (reader.nextKMere(kmer)) {
+        found += filter.containsElement(kmer);
+    }
+    double lookup_time = elapsed(begin);
+
+    std::cout << "view\t" << kmers << "\t\t" << kmers / insert_time / 1e3 << "\t\t" << kmers / lookup_time / 1e3
+              << "\t\t" << kmers - found << std::endl;
+}
+
+
+/**
+ * The same as measureStrings with k-mers packed into integers.
+ */
+template<typename kmer_type>
+void measurePacked(const char *mode, const std::string &path, int k, bool canonical, uint32_t buckets) {
+    CuckooFilter<kmer_type, entries_per_bucket, bits_per_fp, fp_type> filter(2 * buckets);
+    FastaReader reader(path, k, canonical);
+
+    size_t kmers = 0;
+    kmer_type kmer;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    while (reader.nextPackedKMere(kmer)) {
+        filter.insertElement(kmer);
+        kmers++;
+    }
+    double insert_time = elapsed(begin);
+
+    reader.restart();
+    size_t found = 0;
+    begin = std::chrono::steady_clock::now();
+    while (reader.nextPackedKMere(kmer)) {
+        found += filter.containsElement(kmer);
+    }
+    double lookup_time = elapsed(begin);
+
+    std::cout << mode << "\t" << kmers << "\t\t" << kmers / insert_time / 1e3 << "\t\t" << kmers / lookup_time / 1e3
+              << "\t\t" << kmers - found << std::endl;
+}
+
+
+/**
+ * The same as measurePacked with k-mers extracted by rolling iterator, over lines read from stream
+ * or from mapped file according to reader_type.
+ */
+template<typename kmer_type, typename reader_type>
+void measureRolling(const char *mode, const std::string &path, int k, bool canonical, uint32_t buckets) {
+    CuckooFilter<kmer_type, entries_per_bucket, bits_per_fp, fp_type> filter(2 * buckets);
+    reader_type reader(path, k, canonical);
+
+    size_t kmers = 0;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    PackedKMerIterator<kmer_type, reader_type> iterator(&reader);
+    while (iterator.hasNext()) {
+        kmer_type kmer = iterator.next();
+        filter.insertElement(kmer);
+        kmers++;
+    }
+    double insert_time = elapsed(begin);
+
+    size_t found = 0;
+    begin = std::chrono::steady_clock::now();
+    PackedKMerIterator<kmer_type, reader_type> lookups(&reader);
+    while (lookups.hasNext()) {
+        kmer_type kmer = lookups.next();
+        found += filter.containsElement(kmer);
+    }
+    double lookup_time = elapsed(begin);
+
+    std::cout << mode << "\t" << kmers << "\t\t" << kmers / insert_time / 1e3 << "\t\t" << kmers / lookup_time / 1e3
+              << "\t\t" << kmers - found << std::endl;
+}
+
+
+/**
+ * The same as measureRolling with records of mapped file processed in parallel. Every task reads one record
+ * by its own reader sharing the mapping and all threads insert into one concurrent filter.
+ */
+template<typename kmer_type>
+void measureRecords(const std::string &path, int k, bool canonical, uint32_t buckets, size_t threads) {
+    ConcurrentCuckooFilter<kmer_type, entries_per_bucket, bits_per_fp, fp_type> filter(2 * buckets);
+    MappedFastaReader reader(path, k, canonical);
+    ThreadPool pool(threads - 1);
+
+    std::atomic<size_t> kmers(0);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    const std::vector<FastaRecord> &records = reader.getRecords();
+    pool.run(records.size(), [&](size_t i) {
+        MappedFastaReader record(reader, records[i]);
+        PackedKMerIterator<kmer_type, MappedFastaReader> iterator(&record);
+        size_t count = 0;
+        while (iterator.hasNext()) {
+            filter.insertElement(iterator.next());
+            count++;
+        }
+        kmers += count;
+    });
+    double insert_time = elapsed(begin);
+
+    std::atomic<size_t> found(0);
+    begin = std::chrono::steady_clock::now();
+    pool.run(records.size(), [&](size_t i) {
+        MappedFastaReader record(reader, records[i]);
+        PackedKMerIterator<kmer_type, MappedFastaReader> iterator(&record);
+        size_t count = 0;
+        while (iterator.hasNext()) {
+            count += filter.containsElement(iterator.next());
+        }
+        found += count;
+    });
+    double lookup_time = elapsed(begin);
+
+    std::cout << "records\t" << kmers << "\t\t" << kmers / insert_time / 1e3 << "\t\t" << kmers / lookup_time / 1e3
+              << "\t\t" << kmers - found << std::endl;
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("KMerBenchmark", "Insertion and lookup of k-mers of FASTA file in Cuckoo filter");
+    options.add_options()
+            ("f,file", "FASTA file", cxxopts::value<std::string>()->default_value("../Data/ecoli_small.fna"))
+            ("k,kmer", "Size of k-mer", cxxopts::value<int>()->default_value("21"))
+            ("s,buckets", "Table size in buckets", cxxopts::value<double>()->default_value("1e6"))
+            ("g,generate", "Number of random bases written into file before measurement, 0 to use existing file",
+             cxxopts::value<double>()->default_value("0"))
+            ("r,record_length", "Number of bases per record of generated file",
+             cxxopts::value<double>()->default_value("1e6"))
+            ("c,canonical", "K-mers and their reverse complements are stored as one canonical k-mer")
+            ("t,threads", "Number of threads processing records in parallel",
+             cxxopts::value<int>()->default_value("4"));
+    auto result = options.parse(argc, argv);
+
+    std::string path = result["file"].as<std::string>();
+    int k = result["kmer"].as<int>();
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+    size_t generated = (size_t) result["generate"].as<double>();
+    size_t record_length = (size_t) result["record_length"].as<double>();
+    bool canonical = result["canonical"].as<bool>();
+    size_t threads = result["threads"].as<int>();
+
+    if (generated > 0) {
+        generateGenome(path, generated, record_length);
+    }
+
+    std::cout << "Mode\tK-mers\t\tInsert [M/s]\tLookup [M/s]\tFalse negatives" << std::endl;
+    measureStrings(path, k, canonical, buckets);
+    measureViews(path, k, canonical, buckets);
+    if (k <= maxKMerSize<kmer64_t>()) {
+        measurePacked<kmer64_t>("packed", path, k, canonical, buckets);
+        measureRolling<kmer64_t, FastaReader>("rolling", path, k, canonical, buckets);
+        measureRolling<kmer64_t, MappedFastaReader>("mapped", path, k, canonical, buckets);
+        measureRecords<kmer64_t>(path, k, canonical, buckets, threads);
+    } else {
+        measurePacked<kmer128_t>("packed", path, k, canonical, buckets);
+        measureRolling<kmer128_t, FastaReader>("rolling", path, k, canonical, buckets);
+        measureRolling<kmer128_t, MappedFastaReader>("mapped", path, k, canonical, buckets);
+        measureRecords<kmer128_t>(path, k, canonical, buckets, threads);
+    }
+
+    return 0;
+}
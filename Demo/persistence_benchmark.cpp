@@ -0,0 +1,73 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../CF/cuckoo_filter.h"
+#include "benchmark_util.h"
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+typedef CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter_type;
+
+
+/**
+ * Measures time of loading the filter and of the first lookups, which fault in pages of mapped table,
+ * and checks that all stored elements are found.
+ */
+void measureLoad(const std::string &path, bool mapped, size_t stored, size_t queries) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    filter_type *filter = filter_type::load(path, mapped);
+    double load_time = elapsed(begin);
+
+    begin = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for (size_t i = 0; i < queries; i++) {
+        element_type element = scramble((uint32_t) ((i * 2654435761ULL) % stored));
+        found += filter->containsElement(element);
+    }
+    double lookup_time = elapsed(begin);
+
+    std::cout << (mapped ? "mmap" : "copy") << "\t" << load_time << "\t\t" << lookup_time << "\t\t"
+              << queries - found << std::endl;
+    delete filter;
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("FilterPersistenceBenchmark", "Saving Cuckoo filter and loading it by copy or mmap");
+    options.add_options()
+            ("s,buckets", "Table size in buckets", cxxopts::value<double>()->default_value("1e7"))
+            ("l,load", "Load factor of saved filter", cxxopts::value<double>()->default_value("0.9"))
+            ("q,queries", "Number of lookups after loading", cxxopts::value<double>()->default_value("1e6"))
+            ("f,file", "Path of filter file", cxxopts::value<std::string>()->default_value("filter.cf"));
+    auto result = options.parse(argc, argv);
+
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+    double load = result["load"].as<double>();
+    size_t queries = (size_t) result["queries"].as<double>();
+    std::string path = result["file"].as<std::string>();
+
+    size_t stored;
+    {
+        filter_type filter(2 * buckets);
+        stored = (size_t) (load * filter.getTableSize() * entries_per_bucket);
+        for (size_t i = 0; i < stored; i++) {
+            element_type element = scramble((uint32_t) i);
+            filter.insertElement(element);
+        }
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        filter.save(path);
+        std::cout << "Saved " << stored << " elements in " << elapsed(begin) << " ms" << std::endl;
+    }
+
+    std::cout << "Load\tLoad [ms]\tLookups [ms]\tFalse negatives" << std::endl;
+    measureLoad(path, false, stored, queries);
+    measureLoad(path, true, stored, queries);
+
+    remove(path.c_str());
+    return 0;
+}
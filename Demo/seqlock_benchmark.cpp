@@ -0,0 +1,114 @@
+#include "../ArgParser/cxxopts.hpp"
+#include "../CF/cuckoo_filter.h"
+#include "benchmark_util.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+typedef CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter_type;
+
+
+/**
+ * Reader threads look up elements stored before they started, so every miss is a false negative. While
+ * writer is given, it keeps inserting new elements into the same filter until readers finish, deleting
+ * the oldest of its own elements when it has window of them, so that load stays constant.
+ * Writer continues from element next, which is updated.
+ */
+void runReaders(filter_type &filter, size_t stored, size_t queries, size_t readers, size_t window,
+                size_t &next, bool with_writer) {
+    std::atomic<size_t> false_negatives(0);
+    std::atomic<bool> done(false);
+    size_t written = 0;
+
+    std::thread writer;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    if (with_writer) {
+        writer = std::thread([&]() {
+            for (; !done.load(std::memory_order_relaxed); next++) {
+                size_t i = next;
+                element_type element = scramble((uint32_t) i);
+                filter.insertElement(element);
+                written++;
+                if (i >= stored + window) {
+                    filter.deleteElement(scramble((uint32_t) (i - window)));
+                    written++;
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < readers; t++) {
+        threads.emplace_back([&, t]() {
+            size_t missed = 0;
+            for (size_t i = t; i < queries; i += readers) {
+                element_type element = scramble((uint32_t) ((i * 2654435761ULL) % stored));
+                missed += !filter.containsElement(element);
+            }
+            false_negatives += missed;
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    done = true;
+    if (with_writer) {
+        writer.join();
+    }
+    double time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+    std::cout << readers << "\t" << (with_writer ? "yes" : "no") << "\t"
+              << queries / time << "\t\t" << written / time << "\t\t" << false_negatives << std::endl;
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("SeqlockBenchmark", "Lookups of Cuckoo filter in seqlock mode with concurrent writer");
+    options.add_options()
+            ("s,buckets", "Table size in buckets", cxxopts::value<double>()->default_value("1e7"))
+            ("q,queries", "Total number of lookups", cxxopts::value<double>()->default_value("1e8"))
+            ("t,threads", "Maximal number of reader threads, doubled from 1",
+             cxxopts::value<int>()->default_value(std::to_string(std::thread::hardware_concurrency())));
+    auto result = options.parse(argc, argv);
+
+    uint32_t buckets = (uint32_t) result["buckets"].as<double>();
+    size_t queries = (size_t) result["queries"].as<double>();
+    size_t max_threads = result["threads"].as<int>();
+
+    filter_type plain(2 * buckets);
+    filter_type filter(2 * buckets);
+    filter.enableConcurrentReads();
+
+    // readers query first half of elements, writer keeps another 40% of table changing
+    size_t slots = filter.getTableSize() * entries_per_bucket;
+    size_t stored = slots / 2;
+    for (size_t i = 0; i < stored; i++) {
+        element_type element = scramble((uint32_t) i);
+        plain.insertElement(element);
+        filter.insertElement(element);
+    }
+
+    size_t window = (size_t) (0.4 * slots);
+
+    std::cout << "Readers\tWriter\tLookup [Mops/s]\tWrites [Mops/s]\tFalse negatives" << std::endl;
+    std::cout << "Without seqlock:" << std::endl;
+    size_t next = stored;
+    runReaders(plain, stored, queries, 1, window, next, false);
+    std::cout << "With seqlock:" << std::endl;
+    for (size_t readers = 1; readers <= max_threads; readers *= 2) {
+        runReaders(filter, stored, queries, readers, window, next, false);
+    }
+    for (size_t readers = 1; readers <= max_threads; readers *= 2) {
+        runReaders(filter, stored, queries, readers, window, next, true);
+    }
+
+    return 0;
+}
@@ -1,3 +1,4 @@
+#include <ctype.h>
 #include "fasta_reader.h"
 
 
@@ -7,8 +8,11 @@
  *
  * @param fileName FASTA formatted file
  * @param k Size of k-mere.
+ * @param canonical True if k-meres and their reverse complements should be returned as the same k-mere,
+ *        the lexicographically smaller of them
  */
-FastaReader::FastaReader(string fileName, int k) : fileName(std::move(fileName)), k(k) {
+FastaReader::FastaReader(string fileName, int k, bool canonical) : fileName(std::move(fileName)), k(k),
+                                                                   canonical(canonical) {
     if (k <= 0)
         throw std::runtime_error("K-meres should be of size larger than 0.");
     initialize();
@@ -18,20 +22,26 @@ FastaReader::FastaReader(string fileName, int k) : fileName(std::move(fileName))
  * Starting initialization of stream buffer for online k-mere reading.
  */
 void FastaReader::initialize() {
-    currentPosition = new std::ifstream(fileName, std::ifstream::in);
+    currentPosition.close();
+    currentPosition.clear();
+    currentPosition.open(fileName, std::ifstream::in);
     buffer = "";
-    if (!currentPosition->is_open())
+    offset = 0;
+    record = 0;
+    kmereRecord = 0;
+    if (!currentPosition.is_open())
         throw std::runtime_error("Please provide a valid FASTA formatted file! Filename: " + fileName);
 
     while (true) {
         string line;
         // Reading input line
-        if (!std::getline(*currentPosition, line)) break;
+        if (!std::getline(currentPosition, line)) break;
         // Skip empty till FASTA format with ">" appears
         if (line.empty()) continue;
         if (line[0] != '>') continue;
 
         identificator = line.substr(1);
+        kmereIdentificator = identificator;
         prepareNext();
         break;
     }
@@ -46,15 +56,25 @@ void FastaReader::restart() {
 
 /**
  * Preparing buffer for next output. If buffer is of size less than provided k, buffer is cleared and input is finished.
+ * Header line ends the record, bases left in buffer are dropped and following lines belong to the next record.
  */
 void FastaReader::prepareNext() {
-    if (buffer.empty() || buffer.size() < k) {
+    if (buffer.size() - offset < k) {
+        // consumed bases are dropped once per line instead of once per k-mere
+        buffer.erase(0, offset);
+        offset = 0;
         string line;
         while (buffer.size() < k) {
-            if (!std::getline(*currentPosition, line)) {
+            if (!std::getline(currentPosition, line)) {
                 buffer.clear();
                 break;
             }
+            if (!line.empty() && line[0] == '>') {
+                buffer.clear();
+                identificator = line.substr(1);
+                record++;
+                continue;
+            }
             buffer += line;
         }
     }
@@ -68,12 +88,74 @@ string FastaReader::nextKMere() {
     if (buffer.empty()) {
         throw std::runtime_error("There are no more k-meres in genome.");
     }
-    currentKMere = buffer.substr(0, k);
-    buffer = buffer.substr(1);
+    currentKMere = buffer.substr(offset, k);
+    setKMereRecord();
+    offset++;
     prepareNext();
+    if (canonical) {
+        // soft-masked bases are compared as upper case, so that the choice agrees with packed k-meres
+        std::transform(currentKMere.begin(), currentKMere.end(), currentKMere.begin(), ::toupper);
+        string reverse = reverseComplement(currentKMere);
+        if (reverse < currentKMere) {
+            currentKMere.swap(reverse);
+        }
+    }
     return currentKMere;
 }
 
+/**
+ * Remembers record of k-mere at the start of buffer, before following lines are read into it.
+ */
+void FastaReader::setKMereRecord() {
+    if (kmereRecord != record) {
+        kmereRecord = record;
+        kmereIdentificator = identificator;
+    }
+}
+
+/**
+ * Retrieves index of record of the last returned k-mere, records are counted from 0 in order of the file.
+ *
+ * @return Index of record
+ */
+size_t FastaReader::getRecord() {
+    return kmereRecord;
+}
+
+/**
+ * Retrieves header of record of the last returned k-mere, without leading ">".
+ *
+ * @return Identificator of record
+ */
+const string &FastaReader::getIdentificator() {
+    return kmereIdentificator;
+}
+
+/**
+ * Retrieves input which was not read as k-meres yet, the rest of buffer first and then following lines one
+ * by one. Header lines are returned too, bases around them belong to different records. Returned header
+ * starts the next record, so getRecord and getIdentificator then refer to the record of following lines.
+ * Intended for readers which extract k-meres themselves, k-mere reading methods can not be mixed with it.
+ *
+ * @param line Next part of input, valid until the next call
+ * @return False if input is finished
+ */
+bool FastaReader::nextLine(string_view &line) {
+    if (!buffer.empty()) {
+        currentLine = buffer.substr(offset);
+        buffer.clear();
+        offset = 0;
+    } else if (!std::getline(currentPosition, currentLine)) {
+        return false;
+    } else if (!currentLine.empty() && currentLine[0] == '>') {
+        identificator = currentLine.substr(1);
+        record++;
+    }
+    setKMereRecord();
+    line = currentLine;
+    return true;
+}
+
 /**
  * Checks if stream is finished or not.
  * @return True if stream is finished.
@@ -1,41 +1,93 @@
 #ifndef CUCKOOFILTER_FASTAREADER_H
 #define CUCKOOFILTER_FASTAREADER_H
 
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <utility>
 #include <stdexcept>
-#include <string>
+#include <string_view>
+#include "kmer.h"
 
 using namespace std;
 
 /**
  * Implementation of reader of FASTA format.
  * Idea for implementation comes from https://rosettacode.org/wiki/FASTA_format#C.2B.2B
+ * Every header line starts a new record, k-meres never span two records.
  */
 class FastaReader {
 public:
     string fileName;
     int k;
+    // k-meres are returned in canonical form, the smaller of k-mere and its reverse complement, strings in upper case
+    bool canonical;
 
-    FastaReader(string fileName, int k);
+    FastaReader(string fileName, int k, bool canonical = false);
 
     string nextKMere();
 
+    template<typename kmer_type>
+    bool nextPackedKMere(kmer_type &kmer);
+
+    bool nextLine(string_view &line);
+
     bool isDone();
 
     void restart();
 
+    size_t getRecord();
+
+    const string &getIdentificator();
+
 private:
-    ifstream *currentPosition;
+    // stream is reopened by restart
+    ifstream currentPosition;
+    // header and index of record being buffered, counted from 0
     string identificator;
+    size_t record;
+    // header and index of record of the last returned k-mere
+    string kmereIdentificator;
+    size_t kmereRecord;
     string currentKMere;
     string buffer;
+    // position of the next k-mere in buffer, consumed prefix is erased only when the next line is appended
+    size_t offset;
+    // line returned by nextLine
+    string currentLine;
 
     void prepareNext();
 
     void initialize();
+
+    void setKMereRecord();
 };
 
+/**
+ * Packs next k-mer by 2 bits per base without creating its string, k-mers containing other characters
+ * than ACGT are skipped. In canonical mode the smaller of k-mer and its reverse complement is returned.
+ *
+ * @tparam kmer_type kmer64_t or kmer128_t, has to hold k bases
+ * @param kmer Next packed k-mer
+ * @return False if there are no more k-meres
+ */
+template<typename kmer_type>
+bool FastaReader::nextPackedKMere(kmer_type &kmer) {
+    checkKMerSize<kmer_type>(k);
+    while (!buffer.empty()) {
+        bool valid = packKMer(buffer.data() + offset, k, kmer);
+        setKMereRecord();
+        offset++;
+        prepareNext();
+        if (valid) {
+            if (canonical) {
+                kmer = std::min(kmer, reverseComplement(kmer, k));
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
 #endif
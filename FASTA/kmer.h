@@ -0,0 +1,141 @@
+#ifndef CUCKOOFILTER_KMER_H
+#define CUCKOOFILTER_KMER_H
+
+#include <stdint.h>
+#include <string>
+#include <stdexcept>
+
+/**
+ * K-mers packed by 2 bits per base (A = 0, C = 1, G = 2, T = 3), the first base in the highest bits, so that
+ * numeric order of packed k-mers is lexicographic order of their strings. uint64_t holds k-mers of up to
+ * 32 bases and unsigned __int128 of up to 64 bases. Packed k-mers are hashed as integers, without allocation
+ * and string hashing.
+ */
+typedef uint64_t kmer64_t;
+typedef unsigned __int128 kmer128_t;
+
+/**
+ * Code of base in 2 bits, lower case bases are accepted.
+ *
+ * @param base Nucleotide character
+ * @return Code of base, or -1 if character is not one of ACGT (e.g. N)
+ */
+inline int encodeBase(char base) {
+    switch (base) {
+        case 'A': case 'a': return 0;
+        case 'C': case 'c': return 1;
+        case 'G': case 'g': return 2;
+        case 'T': case 't': return 3;
+        default: return -1;
+    }
+}
+
+/**
+ * Maximal size of k-mer which fits into given type.
+ *
+ * @tparam kmer_type Unsigned integer type of packed k-mer
+ * @return Maximal number of bases
+ */
+template<typename kmer_type>
+constexpr int maxKMerSize() {
+    return sizeof(kmer_type) * 4;
+}
+
+/**
+ * Throws std::runtime_error if k-mers of size k do not fit into given type.
+ *
+ * @tparam kmer_type Unsigned integer type of packed k-mer
+ * @param k Size of k-mer
+ */
+template<typename kmer_type>
+inline void checkKMerSize(int k) {
+    if (k <= 0 || k > maxKMerSize<kmer_type>()) {
+        throw std::runtime_error("K-meres of size " + std::to_string(k) + " do not fit into " +
+                                 std::to_string(sizeof(kmer_type) * 8) + "-bit packed k-mer.");
+    }
+}
+
+/**
+ * Packing k bases starting at given position.
+ *
+ * @tparam kmer_type Unsigned integer type of packed k-mer
+ * @param bases First base of k-mer
+ * @param k Size of k-mer
+ * @param kmer Packed k-mer
+ * @return False if k-mer contains other characters than ACGT, kmer is not valid then
+ */
+template<typename kmer_type>
+inline bool packKMer(const char *bases, int k, kmer_type &kmer) {
+    kmer = 0;
+    for (int i = 0; i < k; i++) {
+        int code = encodeBase(bases[i]);
+        if (code < 0) {
+            return false;
+        }
+        kmer = (kmer << 2) | (kmer_type) code;
+    }
+    return true;
+}
+
+/**
+ * Reverse complement of packed k-mer, i.e. k-mer of the opposite strand read in its direction.
+ *
+ * @tparam kmer_type Unsigned integer type of packed k-mer
+ * @param kmer Packed k-mer
+ * @param k Size of k-mer
+ * @return Packed reverse complement
+ */
+template<typename kmer_type>
+inline kmer_type reverseComplement(kmer_type kmer, int k) {
+    kmer_type result = 0;
+    for (int i = 0; i < k; i++) {
+        result = (result << 2) | (3 - (kmer & 3));
+        kmer >>= 2;
+    }
+    return result;
+}
+
+/**
+ * Reverse complement of k-mer string, characters other than ACGT are kept.
+ *
+ * @param kmer K-mer string
+ * @return Reverse complement string
+ */
+inline std::string reverseComplement(const std::string &kmer) {
+    std::string result(kmer.rbegin(), kmer.rend());
+    for (char &base : result) {
+        switch (base) {
+            case 'A': base = 'T'; break;
+            case 'C': base = 'G'; break;
+            case 'G': base = 'C'; break;
+            case 'T': base = 'A'; break;
+            case 'a': base = 't'; break;
+            case 'c': base = 'g'; break;
+            case 'g': base = 'c'; break;
+            case 't': base = 'a'; break;
+            default: break;
+        }
+    }
+    return result;
+}
+
+/**
+ * Converting packed k-mer back to string of upper case bases.
+ *
+ * @tparam kmer_type Unsigned integer type of packed k-mer
+ * @param kmer Packed k-mer
+ * @param k Size of k-mer
+ * @return String of k bases
+ */
+template<typename kmer_type>
+inline std::string unpackKMer(kmer_type kmer, int k) {
+    static const char bases[] = {'A', 'C', 'G', 'T'};
+    std::string result(k, 'A');
+    for (int i = k - 1; i >= 0; i--) {
+        result[i] = bases[(int) (kmer & 3)];
+        kmer >>= 2;
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef CUCKOOFILTER_KMER_ITERATOR_H
+#define CUCKOOFILTER_KMER_ITERATOR_H
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include "fasta_iterator.h"
+#include "fasta_reader.h"
+#include "kmer.h"
+
+using namespace std;
+
+/**
+ * Iterator over k-meres of FastaReader packed by 2 bits per base. K-mere is kept rolling: every base is
+ * shifted in and the oldest one masked off, so each next k-mere costs constant time and no strings are
+ * created. Bases other than ACGT and header lines restart the k-mere, so k-meres containing them are skipped,
+ * as with FastaReader::nextPackedKMere. If reader is canonical, reverse complement is rolled in the opposite
+ * direction along with the k-mere and the smaller of them is returned.
+ *
+ * @tparam kmer_type kmer64_t or kmer128_t, has to hold k bases
+ * @tparam reader_type FastaReader or MappedFastaReader, lines of MappedFastaReader are scanned in the mapping
+ */
+template<typename kmer_type, typename reader_type = FastaReader>
+class PackedKMerIterator : public Iterator<kmer_type> {
+    reader_type *reader;
+    // part of input being scanned and position of the next base in it
+    string_view line;
+    size_t position;
+
+    kmer_type kmer;
+    kmer_type mask;
+    // reverse complement of kmer, maintained only in canonical mode
+    kmer_type reverse;
+    // position of the first base of k-mere in reverse complement
+    int reverse_shift;
+    // number of valid bases at the end of kmer, at most k
+    int valid;
+    // true if kmer holds k-mere which was not returned yet
+    bool ready;
+
+    /**
+     * Rolls kmer over following bases until it holds k valid bases.
+     *
+     * @return False if input is finished
+     */
+    bool advance();
+
+public:
+    PackedKMerIterator(reader_type *reader);
+
+    kmer_type next() override;
+
+    bool hasNext() override;
+};
+
+
+/**
+ * Constructor of packed k-mere iterator. Takes instance of reader and initializes it for new reading.
+ *
+ * @param reader Online implementation of FASTA format reader
+ */
+template<typename kmer_type, typename reader_type>
+PackedKMerIterator<kmer_type, reader_type>::PackedKMerIterator(reader_type *reader) : reader(reader) {
+    checkKMerSize<kmer_type>(reader->k);
+    reader->restart();
+    position = 0;
+    kmer = 0;
+    reverse = 0;
+    reverse_shift = 2 * (reader->k - 1);
+    // shift by the full width of type is undefined
+    mask = reader->k == maxKMerSize<kmer_type>() ? ~(kmer_type) 0 : ((kmer_type) 1 << (2 * reader->k)) - 1;
+    valid = 0;
+    ready = false;
+}
+
+
+template<typename kmer_type, typename reader_type>
+bool PackedKMerIterator<kmer_type, reader_type>::advance() {
+    const int k = reader->k;
+    while (true) {
+        while (position < line.size()) {
+            int code = encodeBase(line[position++]);
+            if (code < 0) {
+                valid = 0;
+                continue;
+            }
+            kmer = ((kmer << 2) | (kmer_type) code) & mask;
+            if (reader->canonical) {
+                // complement of the new base becomes the first base of reverse complement
+                reverse = (reverse >> 2) | ((kmer_type) (3 - code) << reverse_shift);
+            }
+            valid += (valid < k);
+            if (valid == k) {
+                return true;
+            }
+        }
+        if (!reader->nextLine(line)) {
+            return false;
+        }
+        position = 0;
+        if (!line.empty() && line[0] == '>') {
+            // header ends the record, k-meres do not span records
+            valid = 0;
+            position = line.size();
+        }
+    }
+}
+
+
+/**
+ * Getting next packed k-mere, exception is thrown if input is finished.
+ *
+ * @return Next packed k-mere
+ */
+template<typename kmer_type, typename reader_type>
+kmer_type PackedKMerIterator<kmer_type, reader_type>::next() {
+    if (!hasNext()) {
+        throw std::runtime_error("There are no more k-meres in genome.");
+    }
+    ready = false;
+    if (reader->canonical) {
+        return std::min(kmer, reverse);
+    }
+    return kmer;
+}
+
+
+/**
+ * Checks if there is next k-mere in input.
+ *
+ * @return True if stream is not finished.
+ */
+template<typename kmer_type, typename reader_type>
+bool PackedKMerIterator<kmer_type, reader_type>::hasNext() {
+    if (!ready) {
+        ready = advance();
+    }
+    return ready;
+}
+
+#endif
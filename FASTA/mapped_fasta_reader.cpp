@@ -0,0 +1,290 @@
+#include <ctype.h>
+#include <string.h>
+#include <algorithm>
+#include "mapped_fasta_reader.h"
+
+
+/**
+ * Constructor of reader over mapped FASTA file. If file can not be opened, an exception is thrown, same happens
+ * if k is not of satisfying size.
+ *
+ * @param fileName FASTA formatted file
+ * @param k Size of k-mere.
+ * @param canonical True if k-meres and their reverse complements should be returned as the same k-mere,
+ *        the lexicographically smaller of them
+ */
+MappedFastaReader::MappedFastaReader(string fileName, int k, bool canonical) : fileName(std::move(fileName)), k(k),
+                                                                               canonical(canonical) {
+    if (k <= 0)
+        throw std::runtime_error("K-meres should be of size larger than 0.");
+
+    size_t size = getFileSize(this->fileName.c_str());
+    // empty file can not be mapped
+    if (size > 0) {
+        mapping = mapFile(this->fileName.c_str(), 0, size);
+        adviseSequential(mapping);
+    }
+    begin = (const char *) mapping.data;
+    end = begin + mapping.size;
+
+    // Skip lines till FASTA format with ">" appears
+    cursor = begin;
+    sequence = end;
+    firstRecord = 0;
+    string_view header;
+    while (scanLine(header)) {
+        if (!header.empty() && header[0] == '>') {
+            firstIdentificator = header.substr(1);
+            sequence = cursor;
+            break;
+        }
+    }
+
+    join.reserve(2 * k);
+    forward.reserve(k);
+    reverse.reserve(k);
+    restart();
+}
+
+/**
+ * Constructor of reader of single record of already mapped file. Reader shares mapping of the file, which has
+ * to outlive it, and returns only k-meres of the record. Readers of different records can be used in parallel.
+ *
+ * @param file Reader of whole file, its k and canonical mode are taken
+ * @param record Record obtained from getRecords of the file
+ */
+MappedFastaReader::MappedFastaReader(const MappedFastaReader &file, const FastaRecord &record) :
+        fileName(file.fileName), k(file.k), canonical(file.canonical) {
+    records.push_back(record);
+    firstIdentificator = record.identificator;
+    firstRecord = record.index;
+    begin = record.sequence.data();
+    sequence = begin;
+    end = begin + record.sequence.size();
+
+    join.reserve(2 * k);
+    forward.reserve(k);
+    reverse.reserve(k);
+    restart();
+}
+
+MappedFastaReader::~MappedFastaReader() {
+    if (mapping.data != nullptr) {
+        releaseMemory(mapping);
+    }
+}
+
+/**
+ * Initializing reader for new usage, only the cursor is moved back to the sequence.
+ */
+void MappedFastaReader::restart() {
+    cursor = sequence;
+    identificator = firstIdentificator;
+    record = firstRecord;
+    line = string_view();
+    linePosition = 0;
+    join.clear();
+    joinPosition = 0;
+    joinFromLine = 0;
+}
+
+/**
+ * Lists records of the file, header lines starting with ">" are found with memchr. List is created on the first
+ * call, it has to be requested before readers of records are used in parallel. Reader of single record lists
+ * only that record.
+ *
+ * @return Records in order of the file
+ */
+const vector<FastaRecord> &MappedFastaReader::getRecords() {
+    if (!records.empty()) {
+        return records;
+    }
+    const char *position = begin;
+    while (position < end) {
+        const char *header = (const char *) memchr(position, '>', end - position);
+        if (header == nullptr) {
+            break;
+        }
+        position = header + 1;
+        if (header != begin && header[-1] != '\n') {
+            continue;
+        }
+        const char *headerEnd = (const char *) memchr(header, '\n', end - header);
+        headerEnd = headerEnd == nullptr ? end : headerEnd;
+        if (!records.empty()) {
+            // sequence of previous record ends with the new header
+            FastaRecord &previous = records.back();
+            previous.sequence = string_view(previous.sequence.data(), header - previous.sequence.data());
+        }
+        FastaRecord next;
+        next.index = records.size();
+        next.identificator = string_view(header + 1, headerEnd - header - 1);
+        const char *start = headerEnd == end ? end : headerEnd + 1;
+        next.sequence = string_view(start, end - start);
+        records.push_back(next);
+        position = start;
+    }
+    return records;
+}
+
+/**
+ * Retrieves index of record of the last returned k-mere, records are counted from 0 in order of the file.
+ *
+ * @return Index of record
+ */
+size_t MappedFastaReader::getRecord() {
+    return record;
+}
+
+/**
+ * Retrieves header of record of the last returned k-mere, without leading ">".
+ *
+ * @return Identificator of record, view into mapping
+ */
+string_view MappedFastaReader::getIdentificator() {
+    return identificator;
+}
+
+/**
+ * Retrieves next line of input as view into mapping, without the line break. Header lines are returned too,
+ * returned header starts the next record, so getRecord and getIdentificator then refer to the record of
+ * following lines. Intended for readers which extract k-meres themselves, k-mere reading methods can not be
+ * mixed with it.
+ *
+ * @param line Next line
+ * @return False if input is finished
+ */
+bool MappedFastaReader::nextLine(string_view &line) {
+    if (!scanLine(line)) {
+        return false;
+    }
+    if (!line.empty() && line[0] == '>') {
+        identificator = line.substr(1);
+        record++;
+    }
+    return true;
+}
+
+/**
+ * Finds next line of input with memchr, see nextLine.
+ *
+ * @param line Next line
+ * @return False if input is finished
+ */
+bool MappedFastaReader::scanLine(string_view &line) {
+    if (cursor >= end) {
+        return false;
+    }
+    const char *lineEnd = (const char *) memchr(cursor, '\n', end - cursor);
+    if (lineEnd == nullptr) {
+        lineEnd = end;
+    }
+    line = string_view(cursor, lineEnd - cursor);
+    cursor = lineEnd == end ? end : lineEnd + 1;
+    return true;
+}
+
+/**
+ * Moves to the next line of sequence, k-meres are cut from its start. Header line ends the record,
+ * bases left in join are dropped.
+ *
+ * @return False if input is finished
+ */
+bool MappedFastaReader::nextSequenceLine() {
+    string_view next;
+    while (nextLine(next)) {
+        if (next.empty() || next[0] != '>') {
+            line = next;
+            linePosition = 0;
+            joinFromLine = 0;
+            return true;
+        }
+        join.clear();
+        joinPosition = 0;
+    }
+    return false;
+}
+
+/**
+ * Retrieves next k-mere as view, valid until the next call. K-mere lying inside a line points directly into
+ * the mapped file, k-mere spanning line break points into a buffer holding at most 2k - 2 bases around the break.
+ *
+ * @param kmer Next k-mere
+ * @return False if there are no more k-meres
+ */
+bool MappedFastaReader::nextKMere(string_view &kmer) {
+    if (!nextWindow(kmer)) {
+        return false;
+    }
+    if (canonical) {
+        canonize(kmer);
+    }
+    return true;
+}
+
+/**
+ * Retrieves next window of k bases as it is in the file, see nextKMere.
+ *
+ * @param kmer Next window
+ * @return False if there are no more windows
+ */
+bool MappedFastaReader::nextWindow(string_view &kmer) {
+    while (true) {
+        size_t pending = join.size() - joinPosition;
+        if (pending >= (size_t) k) {
+            kmer = string_view(join).substr(joinPosition++, k);
+            return true;
+        }
+        if (pending > 0) {
+            if (pending <= joinFromLine && linePosition - pending + k <= line.size()) {
+                // rest of join is a part of the current line, k-meres are taken from the line again
+                linePosition -= pending;
+                join.clear();
+                joinPosition = 0;
+                continue;
+            }
+            if (linePosition < line.size()) {
+                // k - 1 following bases complete every k-mere starting in join
+                size_t count = std::min(line.size() - linePosition, (size_t) k - 1);
+                join.erase(0, joinPosition);
+                joinPosition = 0;
+                join.append(line.data() + linePosition, count);
+                linePosition += count;
+                joinFromLine += count;
+                continue;
+            }
+        } else if (linePosition + k <= line.size()) {
+            kmer = line.substr(linePosition++, k);
+            return true;
+        } else {
+            // bases left in line start k-meres continuing on the next line
+            join.assign(line.data() + linePosition, line.size() - linePosition);
+            joinPosition = 0;
+            linePosition = line.size();
+        }
+        if (!nextSequenceLine()) {
+            return false;
+        }
+    }
+}
+
+/**
+ * Replaces k-mere by its upper case canonical form, the smaller of k-mere and its reverse complement.
+ *
+ * @param kmer K-mere, afterwards view into internal buffer
+ */
+void MappedFastaReader::canonize(string_view &kmer) {
+    forward.assign(kmer);
+    std::transform(forward.begin(), forward.end(), forward.begin(), ::toupper);
+    reverse.assign(forward.rbegin(), forward.rend());
+    for (char &base : reverse) {
+        switch (base) {
+            case 'A': base = 'T'; break;
+            case 'C': base = 'G'; break;
+            case 'G': base = 'C'; break;
+            case 'T': base = 'A'; break;
+            default: break;
+        }
+    }
+    kmer = reverse < forward ? string_view(reverse) : string_view(forward);
+}
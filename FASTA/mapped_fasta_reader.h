@@ -0,0 +1,126 @@
+#ifndef CUCKOOFILTER_MAPPED_FASTA_READER_H
+#define CUCKOOFILTER_MAPPED_FASTA_READER_H
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <vector>
+#include "kmer.h"
+#include "../Utils/memory_manager.h"
+
+using namespace std;
+
+/**
+ * Record of FASTA file, views into mapped file.
+ */
+struct FastaRecord {
+    // position of record in file, counted from 0
+    size_t index;
+    // header line without leading ">"
+    string_view identificator;
+    // lines of sequence including line breaks, up to the next header
+    string_view sequence;
+};
+
+/**
+ * Reader of FASTA format over file mapped into memory. Lines are found with memchr directly in the mapping,
+ * k-meres are returned as views into it and only k-meres spanning line breaks are joined in a small buffer,
+ * so reading allocates nothing per line or k-mere. Restart only moves the cursor back to the first sequence.
+ * Every header line starts a new record and k-meres never span two records, as with FastaReader.
+ * Records can be listed and read by separate readers sharing the mapping, for example one per thread.
+ */
+class MappedFastaReader {
+public:
+    string fileName;
+    int k;
+    // k-meres are returned in canonical form as in FastaReader, views then point into an internal buffer
+    bool canonical;
+
+    MappedFastaReader(string fileName, int k, bool canonical = false);
+
+    MappedFastaReader(const MappedFastaReader &file, const FastaRecord &record);
+
+    ~MappedFastaReader();
+
+    // reader owns the mapping, readers sharing it are created from records
+    MappedFastaReader(const MappedFastaReader &) = delete;
+
+    MappedFastaReader &operator=(const MappedFastaReader &) = delete;
+
+    const vector<FastaRecord> &getRecords();
+
+    size_t getRecord();
+
+    string_view getIdentificator();
+
+    bool nextKMere(string_view &kmer);
+
+    template<typename kmer_type>
+    bool nextPackedKMere(kmer_type &kmer);
+
+    bool nextLine(string_view &line);
+
+    void restart();
+
+private:
+    // empty in readers of single record, which do not own the mapping
+    MemoryBlock mapping;
+    // records of file, listed on first request
+    vector<FastaRecord> records;
+    // header and index of the first record and of the record being read
+    string_view firstIdentificator;
+    size_t firstRecord;
+    string_view identificator;
+    size_t record;
+    // start of data, first byte after the first header line, end of data and position of the next line
+    const char *begin;
+    const char *sequence;
+    const char *end;
+    const char *cursor;
+
+    // line being cut into k-meres and position of the next k-mere in it
+    string_view line;
+    size_t linePosition;
+    // bases around line break, k-meres starting in it are returned from here
+    string join;
+    size_t joinPosition;
+    // number of bases at the end of join taken from the current line
+    size_t joinFromLine;
+    // upper case k-mere and its reverse complement in canonical mode
+    string forward;
+    string reverse;
+
+    bool scanLine(string_view &line);
+
+    bool nextSequenceLine();
+
+    bool nextWindow(string_view &kmer);
+
+    void canonize(string_view &kmer);
+};
+
+/**
+ * Packs next k-mer by 2 bits per base, k-mers containing other characters than ACGT are skipped.
+ * In canonical mode the smaller of k-mer and its reverse complement is returned.
+ *
+ * @tparam kmer_type kmer64_t or kmer128_t, has to hold k bases
+ * @param kmer Next packed k-mer
+ * @return False if there are no more k-meres
+ */
+template<typename kmer_type>
+bool MappedFastaReader::nextPackedKMere(kmer_type &kmer) {
+    checkKMerSize<kmer_type>(k);
+    string_view window;
+    while (nextWindow(window)) {
+        if (packKMer(window.data(), k, kmer)) {
+            if (canonical) {
+                kmer = std::min(kmer, reverseComplement(kmer, k));
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif
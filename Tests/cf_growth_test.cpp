@@ -0,0 +1,89 @@
+#include <iostream>
+#include <stdio.h>
+#include "../CF/cuckoo_filter.h"
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+typedef CuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter_type;
+
+
+/**
+ * Inserts elements from given one until filter gets full and returns the first element which was not inserted.
+ * The last inserted element may be kept aside as victim.
+ */
+uint32_t fill(filter_type &filter, uint32_t first) {
+    element_type element = first;
+    while (filter.insertElement(element)) {
+        element++;
+    }
+    return element;
+}
+
+
+/**
+ * Counts elements 0 .. stored - 1 which filter does not contain.
+ */
+size_t countFalseNegatives(filter_type &filter, uint32_t stored) {
+    size_t false_negatives = 0;
+    for (element_type element = 0; element < stored; element++) {
+        false_negatives += !filter.containsElement(element);
+    }
+    return false_negatives;
+}
+
+
+/**
+ * Fills filter, doubles it given number of times refilling it after every growth, then saves and loads it,
+ * plain and mapped, and grows the loaded filter once more. Returns number of errors, which are false negatives
+ * and loaded filters differing in table size or growth count.
+ */
+size_t checkGrowth(InsertionStrategy strategy, size_t growths) {
+    filter_type filter(1 << 12, MemoryPolicy::CACHE_ALIGNED, strategy);
+    uint32_t stored = fill(filter, 0);
+    size_t false_negatives = countFalseNegatives(filter, stored);
+    for (size_t round = 0; round < growths; round++) {
+        filter.grow();
+        false_negatives += countFalseNegatives(filter, stored);
+        stored = fill(filter, stored);
+        false_negatives += countFalseNegatives(filter, stored);
+    }
+
+    const std::string path = "cf_growth_test.cf";
+    filter.save(path);
+    size_t mismatches = 0;
+    for (bool mapped : {false, true}) {
+        filter_type *loaded = filter_type::load(path, mapped);
+        mismatches += loaded->getTableSize() != filter.getTableSize()
+                      || loaded->getGrowthCount() != filter.getGrowthCount();
+        false_negatives += countFalseNegatives(*loaded, stored);
+        if (!mapped) {
+            // index complement of loaded filter takes growths into account
+            loaded->grow();
+            false_negatives += countFalseNegatives(*loaded, stored);
+            uint32_t refilled = fill(*loaded, stored);
+            false_negatives += countFalseNegatives(*loaded, refilled);
+        }
+        delete loaded;
+    }
+    remove(path.c_str());
+
+    std::cout << (strategy == InsertionStrategy::BFS ? "BFS" : "random walk") << ": growths "
+              << filter.getGrowthCount() << ", buckets " << filter.getTableSize() << ", elements " << stored
+              << ", false negatives " << false_negatives << ", mismatches after load " << mismatches << std::endl;
+    return false_negatives + mismatches;
+}
+
+
+int main() {
+    size_t errors = 0;
+    errors += checkGrowth(InsertionStrategy::RANDOM_WALK, 6);
+    errors += checkGrowth(InsertionStrategy::BFS, 6);
+
+    if (errors > 0) {
+        std::cout << errors << " errors" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "../DCF/dynamic_cuckoo_filter.h"
+#include <iostream>
+#include <stdio.h>
+
+static const size_t bits_per_fp = 16;
+static const size_t entries_per_bucket = 4;
+typedef uint32_t element_type;
+typedef uint16_t fp_type;
+typedef DynamicCuckooFilter<element_type, entries_per_bucket, bits_per_fp, fp_type> filter_type;
+
+
+/**
+ * Counts elements in range [from, to) which filter does not contain.
+ */
+size_t countFalseNegatives(filter_type &filter, size_t from, size_t to) {
+    size_t false_negatives = 0;
+    for (size_t i = from; i < to; i++) {
+        false_negatives += !filter.containsElement((element_type) i);
+    }
+    return false_negatives;
+}
+
+
+/**
+ * Inserts num_elements elements into filter growing in levels, deletes the given fraction of them, compacts it
+ * and checks that none of the remaining elements is lost, neither after saving and loading the filter.
+ * Returns number of errors, which are false negatives, deletions of contained elements reported as absent,
+ * more ambiguous deletions than false positive rate allows and compaction reclaiming nothing when it should.
+ */
+size_t checkDeletions(size_t table_size, size_t growth_factor, size_t min_fp_bits, size_t threads,
+                      size_t num_elements, double deleted, bool compactable) {
+    filter_type filter(table_size, MemoryPolicy::CACHE_ALIGNED, DEFAULT_SEED, 1, growth_factor, min_fp_bits);
+    filter.enableParallelism(threads);
+    for (size_t i = 0; i < num_elements; i++) {
+        filter.insertElement((element_type) i);
+    }
+    const size_t cf_count = filter.cf_count;
+    // contained element matches another level at most as often as element never inserted matches any filter
+    const double fp_rate = 1.0 - countFalseNegatives(filter, num_elements, 2 * num_elements) / (double) num_elements;
+
+    // elements whose fingerprints match filters of several levels are not deleted
+    const size_t num_deleted = (size_t) (deleted * num_elements);
+    size_t absent = 0, ambiguous = 0;
+    for (size_t i = 0; i < num_deleted; i++) {
+        DeletionResult result = filter.deleteElement((element_type) i);
+        absent += result == DeletionResult::ABSENT;
+        ambiguous += result == DeletionResult::AMBIGUOUS;
+    }
+    const bool ambiguity_bounded = ambiguous <= fp_rate * num_deleted;
+
+    size_t false_negatives = countFalseNegatives(filter, num_deleted, num_elements);
+    size_t reclaimed = filter.compact();
+    false_negatives += countFalseNegatives(filter, num_deleted, num_elements);
+
+    const std::string path = "dcf_geometric_delete_test.dcf";
+    filter.save(path);
+    filter_type *loaded = filter_type::load(path);
+    false_negatives += countFalseNegatives(*loaded, num_deleted, num_elements);
+    // loaded filter keeps levels of its cuckoo filters for deletion and compaction
+    loaded->deleteElement((element_type) num_deleted);
+    loaded->compact();
+    false_negatives += countFalseNegatives(*loaded, num_deleted + 1, num_elements);
+    delete loaded;
+    remove(path.c_str());
+
+    std::cout << "growth factor " << growth_factor << ", min fingerprint bits " << min_fp_bits << ", threads "
+              << threads << ": filters " << cf_count << " -> " << filter.cf_count << ", false positive rate "
+              << fp_rate << ", ambiguous deletions " << ambiguous << ", absent " << absent << ", reclaimed "
+              << reclaimed << " B, false negatives " << false_negatives << std::endl;
+    return false_negatives + absent + !ambiguity_bounded + (compactable && reclaimed == 0);
+}
+
+
+int main() {
+    size_t errors = 0;
+    // every level of growing tables has single filter, there is nothing to compact
+    errors += checkDeletions(4096, 2, 5, 1, 200000, 0.7, false);
+    errors += checkDeletions(4096, 2, 12, 1, 200000, 0.7, false);
+    errors += checkDeletions(4096, 1, 4, 4, 200000, 0.7, true);
+    errors += checkDeletions(4096, 1, 4, 1, 200000, 0.7, true);
+    errors += checkDeletions(4096, 4, 16, 1, 200000, 0.7, true);
+
+    if (errors > 0) {
+        std::cout << errors << " errors" << std::endl;
+        return 1;
+    }
+    return 0;
+}
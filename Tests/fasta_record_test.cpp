@@ -0,0 +1,101 @@
+#include "../FASTA/fasta_reader.h"
+#include "../FASTA/mapped_fasta_reader.h"
+#include "../FASTA/kmer_iterator.h"
+#include <fstream>
+#include <iostream>
+#include <stdio.h>
+#include <vector>
+
+static const int k = 4;
+
+/**
+ * K-mere returned by reader together with record it was reported in.
+ */
+struct RecordKMer {
+    kmer64_t kmer;
+    size_t record;
+    string identificator;
+};
+
+
+/**
+ * Reads k-meres of reader through packed k-mere iterator, which takes input by nextLine.
+ */
+template<typename reader_type>
+vector<RecordKMer> readRolling(reader_type &reader) {
+    vector<RecordKMer> kmers;
+    PackedKMerIterator<kmer64_t, reader_type> iterator(&reader);
+    while (iterator.hasNext()) {
+        kmer64_t kmer = iterator.next();
+        kmers.push_back({kmer, reader.getRecord(), string(reader.getIdentificator())});
+    }
+    return kmers;
+}
+
+
+/**
+ * Reads k-meres of reader by nextPackedKMere.
+ */
+template<typename reader_type>
+vector<RecordKMer> readPacked(reader_type &reader) {
+    vector<RecordKMer> kmers;
+    reader.restart();
+    kmer64_t kmer;
+    while (reader.nextPackedKMere(kmer)) {
+        kmers.push_back({kmer, reader.getRecord(), string(reader.getIdentificator())});
+    }
+    return kmers;
+}
+
+
+/**
+ * Compares k-meres and their records with k-meres read as strings, returns number of differences.
+ */
+size_t compare(const string &name, const vector<RecordKMer> &expected, const vector<RecordKMer> &kmers) {
+    size_t errors = expected.size() != kmers.size();
+    for (size_t i = 0; i < expected.size() && i < kmers.size(); i++) {
+        errors += expected[i].kmer != kmers[i].kmer || expected[i].record != kmers[i].record
+                  || expected[i].identificator != kmers[i].identificator;
+    }
+    std::cout << name << ": " << kmers.size() << " k-meres, " << errors << " differences" << std::endl;
+    return errors;
+}
+
+
+int main() {
+    const string path = "fasta_record_test.fa";
+    std::ofstream out(path);
+    out << ">a\nACGTAC\nGTT\n>b\nTTGCA\n>c\nCAGTACGA\nTT\n";
+    out.close();
+
+    // string k-meres define records every k-mere belongs to
+    vector<RecordKMer> expected;
+    FastaReader reader(path, k);
+    while (!reader.isDone()) {
+        string kmer = reader.nextKMere();
+        kmer64_t packed;
+        packKMer(kmer.data(), k, packed);
+        expected.push_back({packed, reader.getRecord(), reader.getIdentificator()});
+    }
+
+    size_t errors = 0;
+    const size_t records[] = {0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 2, 2, 2, 2, 2};
+    const string identificators = "aaaaaabbccccccc";
+    errors += expected.size() != sizeof(records) / sizeof(records[0]);
+    for (size_t i = 0; i < expected.size() && i < identificators.size(); i++) {
+        errors += expected[i].record != records[i] || expected[i].identificator != identificators.substr(i, 1);
+    }
+
+    errors += compare("FastaReader rolling", expected, readRolling(reader));
+    errors += compare("FastaReader packed", expected, readPacked(reader));
+    MappedFastaReader mapped(path, k);
+    errors += compare("MappedFastaReader rolling", expected, readRolling(mapped));
+    errors += compare("MappedFastaReader packed", expected, readPacked(mapped));
+    remove(path.c_str());
+
+    if (errors > 0) {
+        std::cout << errors << " errors" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -5,32 +5,55 @@
 #include <stdlib.h>
 
 // http://www-graphics.stanford.edu/~seander/bithacks.html
-/**
- * Class for managing bits in memory location.
- * @tparam fp_type
- */
-template<typename fp_type>
-class BitManager {
-public:
-    virtual bool hasvalue(uint64_t value, uint32_t fp) = 0;
-
-    virtual uint32_t read(size_t pos, const uint8_t *p) = 0;
-
-    virtual void write(size_t pos, const uint8_t *p, uint32_t fp) = 0;
-};
 
 /**
  * Class for managing bits of length 4 in memory location.
  * @tparam fp_type
  */
 template<typename fp_type = uint8_t>
-class BitManager4 : public BitManager<fp_type> {
+class BitManager4 {
 public:
-    bool hasvalue(uint64_t value, uint32_t fp);
+    /**
+     * Checking if fingerprint 4-bit fp is bitwise contained in 64-bit value.
+     *
+     * @param value 64-bit value
+     * @param fp Fingerprint for checking
+     * @return True if value contains fingerprint, False otherwise
+     */
+    static inline bool hasvalue(uint64_t value, uint32_t fp) {
+        uint64_t neg = value ^(0x1111ULL * fp);
+        return (neg - 0x1111ULL) & (~neg) & 0x8888ULL;
+    }
 
-    uint32_t read(size_t pos, const uint8_t *p);
+    /**
+     * Reading the bitwise content of fp_type from memory location *p and 4-bit offset pos.
+     *
+     * @param pos Position from start in memory location, offset from start
+     * @param p Memory location
+     * @return Fingerprint saved on location *p with offset pos
+     */
+    static inline uint32_t read(size_t pos, const uint8_t *p) {
+        p += (pos >> 1);
+        return *((fp_type *) p) >> ((pos & 1) << 2);
+    }
 
-    void write(size_t pos, const uint8_t *p, uint32_t fp);
+    /**
+     * Writing content of fingerprint fp to memory location *p with 4-bit offset pos.
+     *
+     * @param pos Position from start in memory location, offset from start
+     * @param p Memory location
+     * @param fp Fingerprint
+     */
+    static inline void write(size_t pos, const uint8_t *p, uint32_t fp) {
+        p += (pos >> 1);
+        if ((pos & 1) == 0) {
+            *((fp_type *) p) &= 0xf0;
+            *((fp_type *) p) |= fp;
+        } else {
+            *((fp_type *) p) &= 0x0f;
+            *((fp_type *) p) |= (fp << 4);
+        }
+    }
 };
 
 /**
@@ -38,13 +61,43 @@ public:
  * @tparam fp_type
  */
 template<typename fp_type = uint8_t>
-class BitManager8 : public BitManager<fp_type> {
+class BitManager8 {
 public:
-    bool hasvalue(uint64_t value, uint32_t fp);
+    /**
+     * Checking if fingerprint 8-bit fp is bitwise contained in 64-bit value.
+     *
+     * @param value 64-bit value
+     * @param fp Fingerprint for checking
+     * @return True if value contains fingerprint, False otherwise
+     */
+    static inline bool hasvalue(uint64_t value, uint32_t fp) {
+        uint64_t neg = value ^(0x01010101ULL * fp);
+        return (neg - 0x01010101ULL) & (~neg) & 0x80808080ULL;
+    }
 
-    uint32_t read(size_t pos, const uint8_t *p);
+    /**
+     * Reading the bitwise content of fp_type from memory location *p and 8-bit offset pos.
+     *
+     * @param pos Position from start in memory location, offset from start
+     * @param p Memory location
+     * @return Fingerprint saved on location *p with offset pos
+     */
+    static inline uint32_t read(size_t pos, const uint8_t *p) {
+        p += pos;
+        fp_type bits = *((fp_type *) p);
+        return bits;
+    }
 
-    void write(size_t pos, const uint8_t *p, uint32_t fp);
+    /**
+     * Writing content of fingerprint fp to memory location *p with 8-bit offset pos.
+     *
+     * @param pos Position from start in memory location, offset from start
+     * @param p Memory location
+     * @param fp Fingerprint
+     */
+    static inline void write(size_t pos, const uint8_t *p, uint32_t fp) {
+        ((fp_type *) p)[pos] = fp;
+    }
 };
 
 
@@ -53,14 +106,49 @@ public:
  * @tparam fp_type
  */
 template<typename fp_type = uint16_t>
-class BitManager12 : public BitManager<fp_type> {
+class BitManager12 {
 public:
+    /**
+     * Checking if fingerprint 12-bit fp is bitwise contained in 64-bit value.
+     *
+     * @param value 64-bit value
+     * @param fp Fingerprint for checking
+     * @return True if value contains fingerprint, False otherwise
+     */
+    static inline bool hasvalue(uint64_t value, uint32_t fp) {
+        uint64_t neg = value ^(0x001001001001ULL * (fp));
+        return (neg - 0x001001001001ULL) & (~neg) & 0x800800800800ULL;
+    }
 
-    bool hasvalue(uint64_t value, uint32_t fp);
+    /**
+     * Reading the bitwise content of fp_type from memory location *p and 12-bit offset pos.
+     *
+     * @param pos Position from start in memory location, offset from start
+     * @param p Memory location
+     * @return Fingerprint saved on location *p with offset pos
+     */
+    static inline uint32_t read(size_t pos, const uint8_t *p) {
+        p += pos + (pos >> 1);
+        return *((fp_type *) p) >> ((pos & 1) << 2);
+    }
 
-    uint32_t read(size_t pos, const uint8_t *p);
-
-    void write(size_t pos, const uint8_t *p, uint32_t fp);
+    /**
+     * Writing content of fingerprint fp to memory location *p with 12-bit offset pos.
+     *
+     * @param pos Position from start in memory location, offset from start
+     * @param p Memory location
+     * @param fp Fingerprint
+     */
+    static inline void write(size_t pos, const uint8_t *p, uint32_t fp) {
+        p += (pos + (pos >> 1));
+        if ((pos & 1) == 0) {
+            ((uint16_t *) p)[0] &= 0xf000;
+            ((fp_type *) p)[0] |= fp;
+        } else {
+            ((fp_type *) p)[0] &= 0x000f;
+            ((fp_type *) p)[0] |= (fp << 4);
+        }
+    }
 };
 
 /**
@@ -68,14 +156,43 @@ public:
  * @tparam fp_type
  */
 template<typename fp_type = uint16_t>
-class BitManager16 : public BitManager<fp_type> {
+class BitManager16 {
 public:
+    /**
+     * Checking if fingerprint 16-bit fp is bitwise contained in 64-bit value.
+     *
+     * @param value 64-bit value
+     * @param fp Fingerprint for checking
+     * @return True if value contains fingerprint, False otherwise
+     */
+    static inline bool hasvalue(uint64_t value, uint32_t fp) {
+        uint64_t neg = value ^(0x0001000100010001ULL * (fp));
+        return (neg - 0x0001000100010001ULL) & (~neg) & 0x8000800080008000ULL;
+    }
 
-    bool hasvalue(uint64_t value, uint32_t fp);
-
-    uint32_t read(size_t pos, const uint8_t *p);
+    /**
+     * Reading the bitwise content of fp_type from memory location *p and 16-bit offset pos.
+     *
+     * @param pos Position from start in memory location, offset from start
+     * @param p Memory location
+     * @return Fingerprint saved on location *p with offset pos
+     */
+    static inline uint32_t read(size_t pos, const uint8_t *p) {
+        p += (pos << 1);
+        fp_type bits = *((fp_type *) p);
+        return bits;
+    }
 
-    void write(size_t pos, const uint8_t *p, uint32_t fp);
+    /**
+     * Writing content of fingerprint fp to memory location *p with 16-bit offset pos.
+     *
+     * @param pos Position from start in memory location, offset from start
+     * @param p Memory location
+     * @param fp Fingerprint
+     */
+    static inline void write(size_t pos, const uint8_t *p, uint32_t fp) {
+        ((fp_type *) p)[pos] = fp;
+    }
 };
 
 /**
@@ -83,14 +200,96 @@ public:
  * @tparam fp_type
  */
 template<typename fp_type = uint32_t>
-class BitManager32 : public BitManager<fp_type> {
+class BitManager32 {
 public:
-    bool hasvalue(uint64_t value, uint32_t fp);
+    /**
+     * Checking if fingerprint 32-bit fp is bitwise contained in 64-bit value.
+     *
+     * @param value 64-bit value
+     * @param fp Fingerprint for checking
+     * @return True if value contains fingerprint, False otherwise
+     */
+    static inline bool hasvalue(uint64_t value, uint32_t fp) {
+        uint64_t neg = value ^(0x0000000100000001ULL * (fp));
+        return (neg - 0x0000000100000001ULL) & (~neg) & 0x8000000080000000ULL;
+    }
 
-    uint32_t read(size_t pos, const uint8_t *p);
+    /**
+     * Reading the bitwise content of fp_type from memory location *p and 32-bit offset pos.
+     *
+     * @param pos Position from start in memory location, offset from start
+     * @param p Memory location
+     * @return Fingerprint saved on location *p with offset pos
+     */
+    static inline uint32_t read(size_t pos, const uint8_t *p) {
+        p += (pos << 2);
+        fp_type bits = *((fp_type *) p);
+        return bits;
+    }
+
+    /**
+     * Writing content of fingerprint fp to memory location *p with 32-bit offset pos.
+     *
+     * @param pos Position from start in memory location, offset from start
+     * @param p Memory location
+     * @param fp Fingerprint
+     */
+    static inline void write(size_t pos, const uint8_t *p, uint32_t fp) {
+        ((fp_type *) p)[pos] = fp;
+    }
+};
 
-    void write(size_t pos, const uint8_t *p, uint32_t fp);
+
+/**
+ * Compile-time selection of the bit manager for parameter triple (entries_per_bucket, bits_per_fp, fp_type).
+ * Every supported triple has its own specialization, all other triples are rejected while compiling.
+ *
+ * @tparam entries_per_bucket Number of entries in bucket
+ * @tparam bits_per_fp Number of bits in fingerprint
+ * @tparam fp_type Fingerprint type
+ */
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+struct BitManagerSelector {
+    static_assert(sizeof(fp_type) == 0,
+                  "Invalid parameters. "
+                  "Supported parameter values for (entries_per_bucket, bits_per_fp, fp_type): "
+                  "{(4,  4, uint8_t), "
+                  "(4,  8, uint8_t), "
+                  "(4, 12, uint16_t), "
+                  "(4, 16, uint16_t), "
+                  "(2, 32, uint32_t)}");
 };
 
+template<>
+struct BitManagerSelector<4, 4, uint8_t> {
+    typedef BitManager4<uint8_t> type;
+};
+
+template<>
+struct BitManagerSelector<4, 8, uint8_t> {
+    typedef BitManager8<uint8_t> type;
+};
+
+template<>
+struct BitManagerSelector<4, 12, uint16_t> {
+    typedef BitManager12<uint16_t> type;
+};
+
+template<>
+struct BitManagerSelector<4, 16, uint16_t> {
+    typedef BitManager16<uint16_t> type;
+};
+
+template<>
+struct BitManagerSelector<2, 32, uint32_t> {
+    typedef BitManager32<uint32_t> type;
+};
+
+/**
+ * Bit manager used by tables with given parameters.
+ */
+template<size_t entries_per_bucket, size_t bits_per_fp, typename fp_type>
+using BitManager = typename BitManagerSelector<entries_per_bucket, bits_per_fp, fp_type>::type;
+
 
 #endif
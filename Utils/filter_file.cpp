@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <string>
+#include "filter_file.h"
+
+
+static_assert(sizeof(FilterFileHeader) <= FILTER_FILE_HEADER_SIZE, "Filter header does not fit into its page");
+
+
+void writeFilterHeader(std::ostream &out, const FilterFileHeader &header) {
+    char page[FILTER_FILE_HEADER_SIZE] = {0};
+    memcpy(page, &header, sizeof(header));
+    out.write(page, sizeof(page));
+    if (!out) {
+        throw std::runtime_error("Writing filter header failed");
+    }
+}
+
+
+FilterFileHeader readFilterHeader(std::istream &in, uint64_t magic) {
+    char page[FILTER_FILE_HEADER_SIZE];
+    in.read(page, sizeof(page));
+    if (!in) {
+        throw std::runtime_error("File is too short for filter header");
+    }
+
+    FilterFileHeader header;
+    memcpy(&header, page, sizeof(header));
+    if (header.magic != magic) {
+        throw std::runtime_error("File does not contain serialized filter");
+    }
+    if (header.version != FILTER_FILE_VERSION) {
+        throw std::runtime_error("Unsupported filter file version " + std::to_string(header.version));
+    }
+    return header;
+}
+
+
+void checkFilterHeader(const FilterFileHeader &header, size_t entries_per_bucket, size_t bits_per_fp,
+                       size_t fp_size, size_t element_size) {
+    if (header.entries_per_bucket != entries_per_bucket || header.bits_per_fp != bits_per_fp ||
+        header.fp_size != fp_size || header.element_size != element_size) {
+        throw std::runtime_error("Filter file was written with different template parameters");
+    }
+}
+
+
+std::string temporaryFilterPath(const std::string &path) {
+    return path + ".tmp." + std::to_string(getpid());
+}
+
+
+void commitFilterFile(std::ofstream &out, const std::string &temporary, const std::string &path) {
+    out.close();
+    if (!out) {
+        remove(temporary.c_str());
+        throw std::runtime_error("Writing filter into " + path + " failed");
+    }
+
+    // data has to reach the disk before the rename, otherwise a crash could leave an empty file under path
+    int fd = open(temporary.c_str(), O_RDONLY);
+    bool synced = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (!synced || rename(temporary.c_str(), path.c_str()) != 0) {
+        remove(temporary.c_str());
+        throw std::runtime_error("Writing filter into " + path + " failed");
+    }
+}
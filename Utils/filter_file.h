@@ -0,0 +1,126 @@
+#ifndef CUCKOOFILTER_FILTER_FILE_H
+#define CUCKOOFILTER_FILTER_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <istream>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+// "CFILTER\0" in little-endian byte order
+#define FILTER_FILE_MAGIC 0x005245544C494643ULL
+// "DCFILTER" in little-endian byte order
+#define DYNAMIC_FILTER_FILE_MAGIC 0x5245544C49464344ULL
+#define FILTER_FILE_VERSION 1
+// header is padded to page size, so that buckets following it can be memory-mapped
+#define FILTER_FILE_HEADER_SIZE 4096
+
+/**
+ * Header of serialized filter. File of cuckoo filter consists of header padded to FILTER_FILE_HEADER_SIZE
+ * bytes followed by raw bucket array of the table. File of dynamic cuckoo filter continues after header
+ * with filter_count records of SubFilterRecord, tables of single filters follow at offsets given
+ * by the records. Numbers are stored in host byte order.
+ */
+struct FilterFileHeader {
+    uint64_t magic = FILTER_FILE_MAGIC;
+    uint32_t version = FILTER_FILE_VERSION;
+
+    // template parameters of the filter
+    uint32_t entries_per_bucket = 0;
+    uint32_t bits_per_fp = 0;
+    uint32_t fp_size = 0;
+    uint32_t element_size = 0;
+    // number of tables stored in file
+    uint32_t filter_count = 1;
+
+    // parameters of HashFunction
+    uint64_t hash_multiply[2] = {0, 0};
+    uint64_t hash_add[2] = {0, 0};
+
+    uint64_t table_size = 0;
+    uint64_t element_count = 0;
+    uint64_t victim_index = 0;
+    uint32_t victim_fp = 0;
+    // position of filter receiving insertions in list of filters
+    uint32_t active_filter = 0;
+
+    // size of one bucket array
+    uint64_t bucket_bytes = 0;
+
+    // number of tables with interleaved buckets in dynamic filter, 0 in files written before it was introduced
+    uint32_t group_size = 1;
+    // number of times cuckoo filter doubled its table by grow, table_size is the current size
+    uint32_t growth_count = 0;
+
+    // geometric growth of dynamic filter, log2 of factor between table sizes of successive levels and
+    // fingerprint bits of the first level, 0 in files written before it was introduced
+    uint32_t growth_shift = 0;
+    uint32_t min_fp_bits = 0;
+};
+
+/**
+ * Record of single cuckoo filter in file of dynamic cuckoo filter, in order of filters.
+ */
+struct SubFilterRecord {
+    // offset of the first bucket from the start of file, buckets of interleaved tables are group_size buckets apart
+    uint64_t table_offset = 0;
+    uint64_t element_count = 0;
+    uint32_t is_full = 0;
+    // level of filter with geometric growth, its table has table_size << (level * growth_shift) buckets,
+    // limited by maximal table size of dynamic filter
+    uint32_t level = 0;
+};
+
+/**
+ * Writing header padded to FILTER_FILE_HEADER_SIZE bytes.
+ *
+ * @param out Output stream
+ * @param header Header of the filter
+ */
+void writeFilterHeader(std::ostream &out, const FilterFileHeader &header);
+
+/**
+ * Reading header padded to FILTER_FILE_HEADER_SIZE bytes, std::runtime_error is thrown if stream does not
+ * start with header of expected kind of filter or its format version is not supported.
+ *
+ * @param in Input stream
+ * @param magic FILTER_FILE_MAGIC or DYNAMIC_FILTER_FILE_MAGIC
+ * @return Header of the filter
+ */
+FilterFileHeader readFilterHeader(std::istream &in, uint64_t magic = FILTER_FILE_MAGIC);
+
+/**
+ * Checking that header was written by filter with the same template parameters, std::runtime_error
+ * is thrown otherwise.
+ *
+ * @param header Header read from file
+ * @param entries_per_bucket Number of entries in bucket
+ * @param bits_per_fp Number of bits in fingerprint
+ * @param fp_size Size of fingerprint type
+ * @param element_size Size of element type
+ */
+void checkFilterHeader(const FilterFileHeader &header, size_t entries_per_bucket, size_t bits_per_fp,
+                       size_t fp_size, size_t element_size);
+
+/**
+ * Returning path of temporary file in the same directory as path. Filter is written into it and moved over
+ * path by commitFilterFile, so that existing file, possibly mapped by a loaded filter, is never truncated
+ * and a failed or interrupted save leaves it intact.
+ *
+ * @param path Path of filter file
+ * @return Path of temporary file
+ */
+std::string temporaryFilterPath(const std::string &path);
+
+/**
+ * Closing written temporary file, flushing it to disk and atomically renaming it to path. Temporary file is
+ * removed and std::runtime_error is thrown if writing or renaming failed.
+ *
+ * @param out Stream writing temporary file
+ * @param temporary Path of temporary file
+ * @param path Path of filter file
+ */
+void commitFilterFile(std::ofstream &out, const std::string &temporary, const std::string &path);
+
+#endif
@@ -14,6 +14,16 @@ HashFunction::HashFunction() {
     }
 }
 
+HashFunction::HashFunction(unsigned __int128 multiply, unsigned __int128 add) : multiply_(multiply), add_(add) {}
+
+unsigned __int128 HashFunction::getMultiply() const {
+    return multiply_;
+}
+
+unsigned __int128 HashFunction::getAdd() const {
+    return add_;
+}
+
 /**
  * CityHash hash function for uint type
  *
@@ -61,10 +71,18 @@ uint64_t HashFunction::murmurHash3Function(std::string *buff, size_t len) {
  * @param key Key of string type
  * @return Hash function for string
  */
-uint64_t HashFunction::hash(std::string key) const {
-//    return murmurHash3Function(&key, (size_t) key.size());
-//    return std::hash<std::string>{}(key);
-    return cityHashFunction(&key, (size_t) key.size());
+uint64_t HashFunction::hash(const std::string &key) const {
+    // key is not copied
+    return CityHash64(key.c_str(), key.size());
+}
+
+/**
+ * Hash function for string views, equal to hash of string with the same characters
+ * @param key View of characters
+ * @return Hash function for string
+ */
+uint64_t HashFunction::hash(std::string_view key) const {
+    return CityHash64(key.data(), key.size());
 }
 
 /**
@@ -74,4 +92,23 @@ uint64_t HashFunction::hash(std::string key) const {
  */
 uint64_t HashFunction::hash(uint32_t key) const {
     return (add_ + multiply_ * static_cast<decltype(multiply_)>(key)) >> 64;
+}
+
+/**
+ * Hash function for 64-bit integer keys, the same multiply-add-shift scheme, which is universal for keys
+ * of 64 bits with 128-bit arithmetic.
+ * @param key Key of integer type
+ * @return Hash function for uint64
+ */
+uint64_t HashFunction::hash(uint64_t key) const {
+    return (add_ + multiply_ * static_cast<decltype(multiply_)>(key)) >> 64;
+}
+
+/**
+ * Hash function for 128-bit integer keys. Hash of upper half is folded into lower half, which is hashed then.
+ * @param key Key of integer type
+ * @return Hash function for uint128
+ */
+uint64_t HashFunction::hash(unsigned __int128 key) const {
+    return hash((uint64_t) key ^ hash((uint64_t) (key >> 64)));
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 
 #include <random>
+#include <string_view>
 #include "city.h"
 #include "murmur_hash3.h"
 
@@ -21,9 +22,25 @@ private:
 public:
     HashFunction();
 
+    // restoring hash function with parameters of serialized filter
+    HashFunction(unsigned __int128 multiply, unsigned __int128 add);
+
+    unsigned __int128 getMultiply() const;
+
+    unsigned __int128 getAdd() const;
+
     uint64_t hash(uint32_t key) const;
 
-    uint64_t hash(std::string key) const;
+    // packed k-mers of up to 32 bases
+    uint64_t hash(uint64_t key) const;
+
+    // packed k-mers of up to 64 bases
+    uint64_t hash(unsigned __int128 key) const;
+
+    uint64_t hash(const std::string &key) const;
+
+    // views of k-mers into mapped FASTA file
+    uint64_t hash(std::string_view key) const;
 
     static uint64_t cityHashFunction(uint32_t *buff, size_t len);
 
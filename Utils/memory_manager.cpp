@@ -0,0 +1,164 @@
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "memory_manager.h"
+
+
+static size_t roundUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Mapping anonymous memory from the huge page pool. Fails if pool is not configured
+ * (/proc/sys/vm/nr_hugepages) or too small.
+ *
+ * @param block Block to fill
+ * @return True if memory is mapped
+ */
+static bool allocateExplicitHugePages(MemoryBlock &block) {
+#ifdef MAP_HUGETLB
+    void *p = mmap(nullptr, block.size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    block.data = (uint8_t *) p;
+    block.policy = MemoryPolicy::EXPLICIT_HUGE_PAGES;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Allocating memory aligned to given boundary. Memory is not initialized.
+ *
+ * @param block Block to fill
+ * @param alignment Alignment in bytes
+ * @return True if memory is allocated
+ */
+static bool allocateAligned(MemoryBlock &block, size_t alignment) {
+    void *p;
+    if (posix_memalign(&p, alignment, block.size) != 0) {
+        return false;
+    }
+    block.data = (uint8_t *) p;
+    return true;
+}
+
+
+MemoryBlock allocateMemory(size_t size, MemoryPolicy policy) {
+    MemoryBlock block;
+
+    if (policy == MemoryPolicy::EXPLICIT_HUGE_PAGES) {
+        block.size = roundUp(size, HUGE_PAGE_SIZE);
+        if (allocateExplicitHugePages(block)) {
+            return block;
+        }
+        policy = MemoryPolicy::TRANSPARENT_HUGE_PAGES;
+    }
+
+    if (policy == MemoryPolicy::TRANSPARENT_HUGE_PAGES) {
+        block.size = roundUp(size, HUGE_PAGE_SIZE);
+        if (allocateAligned(block, HUGE_PAGE_SIZE)) {
+#ifdef MADV_HUGEPAGE
+            // only a hint, kernel without THP support rejects it and uses regular pages
+            madvise(block.data, block.size, MADV_HUGEPAGE);
+#endif
+            // touching memory after the hint, so that pages are faulted in as huge pages
+            memset(block.data, 0, block.size);
+            block.policy = MemoryPolicy::TRANSPARENT_HUGE_PAGES;
+            return block;
+        }
+    }
+
+    block.size = roundUp(size, CACHE_LINE_SIZE);
+    if (!allocateAligned(block, CACHE_LINE_SIZE)) {
+        throw std::bad_alloc();
+    }
+    memset(block.data, 0, block.size);
+    block.policy = MemoryPolicy::CACHE_ALIGNED;
+    return block;
+}
+
+
+void releaseMemory(MemoryBlock &block) {
+    if (!block.data) return;
+
+    if (block.policy == MemoryPolicy::EXPLICIT_HUGE_PAGES) {
+        munmap(block.data, block.size);
+    } else if (block.policy == MemoryPolicy::MAPPED_FILE || block.policy == MemoryPolicy::MAPPED_FILE_PRIVATE) {
+        munmap(block.data - block.offset, block.offset + block.size);
+    } else {
+        free(block.data);
+    }
+    block.data = nullptr;
+    block.size = 0;
+}
+
+
+size_t decommitMemory(uint8_t *data, size_t size, MemoryPolicy policy) {
+    if (policy == MemoryPolicy::EXPLICIT_HUGE_PAGES || policy == MemoryPolicy::MAPPED_FILE) {
+        return 0;
+    }
+
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t first = roundUp((uintptr_t) data, page_size);
+    uintptr_t last = ((uintptr_t) data + size) / page_size * page_size;
+    if (last <= first || madvise((void *) first, last - first, MADV_DONTNEED) != 0) {
+        return 0;
+    }
+    return last - first;
+}
+
+
+MemoryBlock mapFile(const char *path, size_t offset, size_t size, bool writable) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Can not open file ") + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < offset + size) {
+        close(fd);
+        throw std::runtime_error(std::string("File ") + path + " is shorter than expected");
+    }
+
+    void *p = writable ? mmap(nullptr, offset + size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+                       : mmap(nullptr, offset + size, PROT_READ, MAP_SHARED, fd, 0);
+    // mapping holds its own reference to the file
+    close(fd);
+    if (p == MAP_FAILED) {
+        throw std::runtime_error(std::string("Can not map file ") + path);
+    }
+
+    MemoryBlock block;
+    block.data = (uint8_t *) p + offset;
+    block.size = size;
+    block.offset = offset;
+    block.policy = writable ? MemoryPolicy::MAPPED_FILE_PRIVATE : MemoryPolicy::MAPPED_FILE;
+    return block;
+}
+
+
+size_t getFileSize(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        throw std::runtime_error(std::string("Can not open file ") + path);
+    }
+    return st.st_size;
+}
+
+
+void adviseSequential(const MemoryBlock &block) {
+    if (block.policy != MemoryPolicy::MAPPED_FILE && block.policy != MemoryPolicy::MAPPED_FILE_PRIVATE) {
+        return;
+    }
+    // mapping starts at the beginning of file, offset is not page aligned
+    madvise(block.data - block.offset, block.offset + block.size, MADV_SEQUENTIAL);
+}
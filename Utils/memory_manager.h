@@ -0,0 +1,99 @@
+#ifndef CUCKOOFILTER_MEMORY_MANAGER_H
+#define CUCKOOFILTER_MEMORY_MANAGER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define CACHE_LINE_SIZE 64
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/**
+ * Policy of allocating table storage. Every policy aligns memory at least to the cache line,
+ * huge page policies fall back to weaker ones if huge pages are not available on the system:
+ * EXPLICIT_HUGE_PAGES -> TRANSPARENT_HUGE_PAGES -> CACHE_ALIGNED.
+ */
+enum class MemoryPolicy {
+    // memory aligned to CACHE_LINE_SIZE bytes
+    CACHE_ALIGNED,
+    // memory aligned to HUGE_PAGE_SIZE and advised to be backed by transparent huge pages (madvise)
+    TRANSPARENT_HUGE_PAGES,
+    // memory mapped from reserved huge pages pool (mmap with MAP_HUGETLB)
+    EXPLICIT_HUGE_PAGES,
+    // read-only mapping of a file, obtained only with mapFile
+    MAPPED_FILE,
+    // copy-on-write mapping of a file, modified pages are private and never written back, obtained only with mapFile
+    MAPPED_FILE_PRIVATE
+};
+
+/**
+ * Block of memory obtained from memory manager. Policy holds the policy which was actually used,
+ * which can differ from requested one after fallback.
+ */
+struct MemoryBlock {
+    uint8_t *data = nullptr;
+    size_t size = 0;
+    MemoryPolicy policy = MemoryPolicy::CACHE_ALIGNED;
+    // bytes of file mapping preceding data
+    size_t offset = 0;
+};
+
+/**
+ * Allocating zero-initialized memory block of at least given size with requested policy.
+ * If memory can not be allocated even with CACHE_ALIGNED policy, std::bad_alloc is thrown.
+ *
+ * @param size Minimal size of block in bytes
+ * @param policy Requested allocation policy
+ * @return Allocated memory block
+ */
+MemoryBlock allocateMemory(size_t size, MemoryPolicy policy);
+
+/**
+ * Releasing memory block previously obtained with allocateMemory.
+ *
+ * @param block Memory block
+ */
+void releaseMemory(MemoryBlock &block);
+
+/**
+ * Returning physical pages lying entirely inside given range of block to the system, while the range
+ * stays allocated. Pages of anonymous memory read as zero afterwards and are faulted in again on access.
+ * Explicit huge pages and read-only file mappings are kept.
+ *
+ * @param data Start of range
+ * @param size Size of range in bytes
+ * @param policy Policy of block containing the range
+ * @return number of bytes returned to the system
+ */
+size_t decommitMemory(uint8_t *data, size_t size, MemoryPolicy policy);
+
+/**
+ * Mapping part of file into memory, pages are loaded lazily from page cache. File is mapped from
+ * its start and data points to given offset, so that offset need not be aligned to page size.
+ * Writable mapping is private, written pages are copied and the file is never modified.
+ * std::runtime_error is thrown if file can not be mapped or is shorter than offset + size.
+ *
+ * @param path Path to file
+ * @param offset Offset of mapped data in file
+ * @param size Size of mapped data in bytes
+ * @param writable True for copy-on-write mapping, read-only mapping otherwise
+ * @return Memory block with MAPPED_FILE or MAPPED_FILE_PRIVATE policy
+ */
+MemoryBlock mapFile(const char *path, size_t offset, size_t size, bool writable = false);
+
+/**
+ * Returning size of file in bytes, std::runtime_error is thrown if file can not be opened.
+ *
+ * @param path Path to file
+ * @return Size of file
+ */
+size_t getFileSize(const char *path);
+
+/**
+ * Advising the system that mapped block will be read sequentially, so that pages are read ahead
+ * aggressively and dropped soon after they were read. Advice is ignored for other blocks.
+ *
+ * @param block Block obtained with mapFile
+ */
+void adviseSequential(const MemoryBlock &block);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef CUCKOOFILTER_RANDOM_H
+#define CUCKOOFILTER_RANDOM_H
+
+#include <stdint.h>
+
+// seed of filters constructed without explicit seed
+#define DEFAULT_SEED 0x9E3779B97F4A7C15ULL
+
+/**
+ * Small and fast pseudo-random generator (wyrand) used for choosing evicted entries. Every table owns
+ * its generator, so kicks neither share state nor lock like rand() does, and sequence of evictions
+ * is reproducible for given seed.
+ */
+class FastRandom {
+
+private:
+    uint64_t state;
+
+public:
+    /**
+     * Constructing generator with given seed.
+     *
+     * @param seed Seed of the generator
+     */
+    explicit FastRandom(uint64_t seed = DEFAULT_SEED) : state(seed) {}
+
+    /**
+     * Returns next 64-bit pseudo-random number.
+     *
+     * @return Pseudo-random number
+     */
+    inline uint64_t next() {
+        state += 0xa0761d6478bd642fULL;
+        __uint128_t t = (__uint128_t) state * (state ^ 0xe7037ed1a0b428dbULL);
+        return (uint64_t) (t >> 64) ^ (uint64_t) t;
+    }
+
+    /**
+     * Returns pseudo-random number from interval [0, n).
+     *
+     * @param n Upper bound, exclusive
+     * @return Pseudo-random number lower than n
+     */
+    inline uint32_t nextBelow(uint32_t n) {
+        return (uint32_t) (((next() & 0xFFFFFFFFULL) * n) >> 32);
+    }
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include "simd_probe.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+
+/**
+ * Replicates fingerprint in lowest lane of every 64-bit element to all lanes of the element.
+ */
+template<size_t bits_per_fp>
+__attribute__((target("avx2")))
+static inline __m256i broadcastLanes(__m256i fp) {
+    if constexpr (bits_per_fp <= 8) fp = _mm256_or_si256(fp, _mm256_slli_epi64(fp, 8));
+    if constexpr (bits_per_fp <= 16) fp = _mm256_or_si256(fp, _mm256_slli_epi64(fp, 16));
+    return _mm256_or_si256(fp, _mm256_slli_epi64(fp, 32));
+}
+
+
+template<size_t bits_per_fp>
+__attribute__((target("avx2")))
+static inline __m256i compareLanes(__m256i words, __m256i fp) {
+    if constexpr (bits_per_fp == 8) return _mm256_cmpeq_epi8(words, fp);
+    if constexpr (bits_per_fp == 16) return _mm256_cmpeq_epi16(words, fp);
+    return _mm256_cmpeq_epi32(words, fp);
+}
+
+
+/**
+ * AVX2 kernel, gathers both buckets of 4 keys and compares them with fingerprints in two 256-bit registers.
+ */
+template<size_t bits_per_fp, size_t bytes_per_bucket>
+__attribute__((target("avx2")))
+static size_t probeAVX2(const uint8_t *buckets, const size_t *i1, const size_t *i2, const uint32_t *fps,
+                        size_t count, bool *out) {
+    const int shift = bytes_per_bucket == 8 ? 3 : 2;
+    const uint32_t valid = (1u << bytes_per_bucket) - 1;
+    const long long *base = (const long long *) buckets;
+
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m256i o1 = _mm256_slli_epi64(_mm256_loadu_si256((const __m256i *) (i1 + k)), shift);
+        __m256i o2 = _mm256_slli_epi64(_mm256_loadu_si256((const __m256i *) (i2 + k)), shift);
+        __m256i w1 = _mm256_i64gather_epi64(base, o1, 1);
+        __m256i w2 = _mm256_i64gather_epi64(base, o2, 1);
+
+        __m256i fp = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *) (fps + k)));
+        fp = broadcastLanes<bits_per_fp>(fp);
+
+        __m256i eq = _mm256_or_si256(compareLanes<bits_per_fp>(w1, fp), compareLanes<bits_per_fp>(w2, fp));
+        uint32_t m = (uint32_t) _mm256_movemask_epi8(eq);
+
+        out[k] = m & valid;
+        out[k + 1] = (m >> 8) & valid;
+        out[k + 2] = (m >> 16) & valid;
+        out[k + 3] = (m >> 24) & valid;
+    }
+    return k;
+}
+
+
+// GCC 12 reports undefined initial value of registers in avx512fintrin.h as possibly uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/**
+ * AVX-512 kernel, gathers both buckets of 8 keys and compares them with fingerprints in two 512-bit registers.
+ */
+template<size_t bits_per_fp, size_t bytes_per_bucket>
+__attribute__((target("avx512f,avx512bw")))
+static size_t probeAVX512(const uint8_t *buckets, const size_t *i1, const size_t *i2, const uint32_t *fps,
+                          size_t count, bool *out) {
+    const int shift = bytes_per_bucket == 8 ? 3 : 2;
+    // compare mask holds one bit per lane
+    const size_t lanes = 64 / bits_per_fp;
+    const uint64_t valid = (1u << (bytes_per_bucket * 8 / bits_per_fp)) - 1;
+    const void *base = buckets;
+
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m512i o1 = _mm512_slli_epi64(_mm512_loadu_si512((const void *) (i1 + k)), shift);
+        __m512i o2 = _mm512_slli_epi64(_mm512_loadu_si512((const void *) (i2 + k)), shift);
+        __m512i w1 = _mm512_i64gather_epi64(o1, base, 1);
+        __m512i w2 = _mm512_i64gather_epi64(o2, base, 1);
+
+        __m512i fp = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i *) (fps + k)));
+        if constexpr (bits_per_fp <= 8) fp = _mm512_or_si512(fp, _mm512_slli_epi64(fp, 8));
+        if constexpr (bits_per_fp <= 16) fp = _mm512_or_si512(fp, _mm512_slli_epi64(fp, 16));
+        fp = _mm512_or_si512(fp, _mm512_slli_epi64(fp, 32));
+
+        uint64_t m;
+        if constexpr (bits_per_fp == 8) {
+            m = _mm512_cmpeq_epi8_mask(w1, fp) | _mm512_cmpeq_epi8_mask(w2, fp);
+        } else if constexpr (bits_per_fp == 16) {
+            m = _mm512_cmpeq_epi16_mask(w1, fp) | _mm512_cmpeq_epi16_mask(w2, fp);
+        } else {
+            m = _mm512_cmpeq_epi32_mask(w1, fp) | _mm512_cmpeq_epi32_mask(w2, fp);
+        }
+
+        for (size_t j = 0; j < 8; j++) {
+            out[k + j] = (m >> (j * lanes)) & valid;
+        }
+    }
+    return k;
+}
+
+#pragma GCC diagnostic pop
+
+
+static SimdLevel detectSimdLevel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    return SimdLevel::SWAR;
+}
+
+#else
+
+static SimdLevel detectSimdLevel() {
+    return SimdLevel::SWAR;
+}
+
+#endif
+
+
+static SimdLevel &activeSimdLevel() {
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+
+SimdLevel getSimdLevel() {
+    return activeSimdLevel();
+}
+
+
+SimdLevel setSimdLevel(SimdLevel level) {
+    static const SimdLevel supported = detectSimdLevel();
+    activeSimdLevel() = (int) level < (int) supported ? level : supported;
+    return activeSimdLevel();
+}
+
+
+const char *simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::AVX512:
+            return "AVX-512";
+        default:
+            return "SWAR";
+    }
+}
+
+
+size_t probeBucketPairs(const uint8_t *buckets, size_t bytes_per_bucket, size_t bits_per_fp,
+                        const size_t *i1, const size_t *i2, const uint32_t *fps, size_t count, bool *out) {
+#if defined(__x86_64__)
+    switch (activeSimdLevel()) {
+        case SimdLevel::AVX512:
+            if (bits_per_fp == 8 && bytes_per_bucket == 4) return probeAVX512<8, 4>(buckets, i1, i2, fps, count, out);
+            if (bits_per_fp == 16 && bytes_per_bucket == 8) return probeAVX512<16, 8>(buckets, i1, i2, fps, count, out);
+            if (bits_per_fp == 32 && bytes_per_bucket == 8) return probeAVX512<32, 8>(buckets, i1, i2, fps, count, out);
+            break;
+        case SimdLevel::AVX2:
+            if (bits_per_fp == 8 && bytes_per_bucket == 4) return probeAVX2<8, 4>(buckets, i1, i2, fps, count, out);
+            if (bits_per_fp == 16 && bytes_per_bucket == 8) return probeAVX2<16, 8>(buckets, i1, i2, fps, count, out);
+            if (bits_per_fp == 32 && bytes_per_bucket == 8) return probeAVX2<32, 8>(buckets, i1, i2, fps, count, out);
+            break;
+        default:
+            break;
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,119 @@
+#ifndef CUCKOOFILTER_SIMD_PROBE_H
+#define CUCKOOFILTER_SIMD_PROBE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Instruction set used by batched bucket probes. AVX2 and AVX-512 kernels are selected at runtime
+ * according to the CPU, SWAR probe of BitManager is the fallback.
+ */
+enum class SimdLevel {
+    // one bucket per 64-bit word, BitManager::hasvalue
+    SWAR,
+    // 4 keys (8 buckets) per 256-bit register
+    AVX2,
+    // 8 keys (16 buckets) per 512-bit register, requires AVX-512F and AVX-512BW
+    AVX512
+};
+
+/**
+ * Returns SIMD level currently used by batched probes.
+ *
+ * @return Active SIMD level
+ */
+SimdLevel getSimdLevel();
+
+/**
+ * Sets SIMD level used by batched probes, e.g. for comparing kernels. Level is limited to the one supported
+ * by the CPU.
+ *
+ * @param level Requested SIMD level
+ * @return SIMD level which is actually used
+ */
+SimdLevel setSimdLevel(SimdLevel level);
+
+/**
+ * Returns name of SIMD level.
+ *
+ * @param level SIMD level
+ * @return Name of the level
+ */
+const char *simdLevelName(SimdLevel level);
+
+/**
+ * Checks if bucket layout can be probed by vector kernels. Fingerprints have to fill whole 8, 16 or 32-bit
+ * lanes and bucket has to take 4 or 8 bytes, so that it can be gathered as one 64-bit word.
+ *
+ * @param entries_per_bucket Number of entries in bucket
+ * @param bits_per_fp Number of bits in fingerprint
+ * @return True if vector kernels support the layout
+ */
+constexpr bool simdProbeSupported(size_t entries_per_bucket, size_t bits_per_fp) {
+#if defined(__x86_64__)
+    return (bits_per_fp == 8 || bits_per_fp == 16 || bits_per_fp == 32) &&
+           (entries_per_bucket * bits_per_fp == 32 || entries_per_bucket * bits_per_fp == 64);
+#else
+    return false;
+#endif
+}
+
+/**
+ * Probes both candidate buckets of several keys at once with the active vector kernel. Buckets are gathered
+ * as 64-bit words, so storage has to be padded by 8 bytes after the last bucket. Only whole vectors are probed,
+ * remaining keys are left to the caller.
+ *
+ * @param buckets Start of bucket storage
+ * @param bytes_per_bucket Bucket size in bytes, 4 or 8
+ * @param bits_per_fp Number of bits in fingerprint, 8, 16 or 32
+ * @param i1 First bucket indices
+ * @param i2 Second bucket indices
+ * @param fps Fingerprints
+ * @param count Number of keys
+ * @param out True for key k if fps[k] is in bucket i1[k] or i2[k]
+ * @return Number of probed keys from the start, 0 if no vector kernel is active
+ */
+size_t probeBucketPairs(const uint8_t *buckets, size_t bytes_per_bucket, size_t bits_per_fp,
+                        const size_t *i1, const size_t *i2, const uint32_t *fps, size_t count, bool *out);
+
+/**
+ * Probes both candidate buckets of a single key in one 128-bit register.
+ *
+ * @tparam bits_per_fp Number of bits in fingerprint, 8, 16 or 32
+ * @tparam bytes_per_bucket Bucket size in bytes, 4 or 8
+ * @param w1 64-bit word with first bucket in lowest bytes
+ * @param w2 64-bit word with second bucket in lowest bytes
+ * @param fp Fingerprint for checking
+ * @return True if any bucket contains fingerprint
+ */
+template<size_t bits_per_fp, size_t bytes_per_bucket>
+inline bool probeBucketPair(uint64_t w1, uint64_t w2, uint32_t fp) {
+    // bytes of both 64-bit halves which belong to the buckets
+    const int valid = ((1 << bytes_per_bucket) - 1) * 0x0101;
+#if defined(__SSE2__)
+    __m128i words = _mm_set_epi64x((long long) w2, (long long) w1);
+    __m128i eq;
+    if constexpr (bits_per_fp == 8) {
+        eq = _mm_cmpeq_epi8(words, _mm_set1_epi8((char) fp));
+    } else if constexpr (bits_per_fp == 16) {
+        eq = _mm_cmpeq_epi16(words, _mm_set1_epi16((short) fp));
+    } else {
+        eq = _mm_cmpeq_epi32(words, _mm_set1_epi32((int) fp));
+    }
+    return _mm_movemask_epi8(eq) & valid;
+#else
+    const uint64_t mask = (1ULL << bits_per_fp) - 1;
+    for (size_t j = 0; j < bytes_per_bucket * 8 / bits_per_fp; j++) {
+        if (((w1 >> (j * bits_per_fp)) & mask) == fp || ((w2 >> (j * bits_per_fp)) & mask) == fp) {
+            return true;
+        }
+    }
+    return false;
+#endif
+}
+
+#endif
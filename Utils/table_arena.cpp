@@ -0,0 +1,77 @@
+#include <string.h>
+#include <algorithm>
+#include "table_arena.h"
+
+
+TableArena::TableArena(size_t table_bytes, MemoryPolicy policy, size_t max_free_tables) {
+    table_bytes_ = (table_bytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    policy_ = policy;
+    max_free_ = max_free_tables;
+}
+
+
+TableArena::~TableArena() {
+    for (MemoryBlock &chunk : chunks_) {
+        releaseMemory(chunk);
+    }
+}
+
+
+uint8_t *TableArena::acquire() {
+    std::vector<uint8_t *> &reused = free_.empty() ? decommitted_ : free_;
+    if (!reused.empty()) {
+        uint8_t *table = reused.back();
+        reused.pop_back();
+        // partial pages at table ends are not decommitted, so table is cleared in both cases
+        memset(table, 0, table_bytes_);
+        return table;
+    }
+
+    if (chunk_used_ == chunk_tables_) {
+        // small filters do not pay for a whole chunk
+        chunk_tables_ = std::min((size_t) ARENA_CHUNK_TABLES, (size_t) 1 << chunks_.size());
+        chunks_.push_back(allocateMemory(chunk_tables_ * table_bytes_, policy_));
+        chunk_used_ = 0;
+    }
+    // chunks are zero-initialized by memory manager
+    return chunks_.back().data + table_bytes_ * chunk_used_++;
+}
+
+
+void TableArena::release(uint8_t *table) {
+    if (free_.size() < max_free_) {
+        free_.push_back(table);
+        return;
+    }
+    decommitMemory(table, table_bytes_, policy_);
+    decommitted_.push_back(table);
+}
+
+
+void TableArena::setMaxFreeTables(size_t max_free_tables) {
+    max_free_ = max_free_tables;
+    while (free_.size() > max_free_) {
+        decommitMemory(free_.back(), table_bytes_, policy_);
+        decommitted_.push_back(free_.back());
+        free_.pop_back();
+    }
+}
+
+
+size_t TableArena::getFreeTables() const {
+    return free_.size() + decommitted_.size();
+}
+
+
+size_t TableArena::getTableBytes() const {
+    return table_bytes_;
+}
+
+
+size_t TableArena::getAllocatedBytes() const {
+    size_t bytes = 0;
+    for (const MemoryBlock &chunk : chunks_) {
+        bytes += chunk.size;
+    }
+    return bytes;
+}
@@ -0,0 +1,106 @@
+#ifndef CUCKOOFILTER_TABLE_ARENA_H
+#define CUCKOOFILTER_TABLE_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "memory_manager.h"
+
+// maximal number of tables carved out of one chunk, chunks grow 1, 2, 4, ... up to this size
+#define ARENA_CHUNK_TABLES 8
+// default number of released tables kept resident for reuse
+#define ARENA_MAX_FREE_TABLES 4
+
+/**
+ * Arena of equally sized tables. Tables are carved out of large chunks of memory obtained from memory
+ * manager, so that tables of one dynamic filter lie close to each other instead of being scattered
+ * over the heap. Released tables are kept for reuse. Only a limited number of them stays resident, pages
+ * of further released tables are returned to the system and faulted in again when the table is reused.
+ * Address space is returned only when arena is destroyed.
+ */
+class TableArena {
+
+private:
+    // size of one table including padding, multiple of CACHE_LINE_SIZE
+    size_t table_bytes_;
+
+    // policy of allocating chunks
+    MemoryPolicy policy_;
+
+    // allocated chunks
+    std::vector<MemoryBlock> chunks_;
+
+    // number of tables in the last chunk and number of them already carved out
+    size_t chunk_tables_ = 0;
+    size_t chunk_used_ = 0;
+
+    // released tables available for reuse
+    std::vector<uint8_t *> free_;
+    // released tables whose pages were returned to the system, reused after free ones
+    std::vector<uint8_t *> decommitted_;
+    // maximal number of resident released tables
+    size_t max_free_;
+
+public:
+    /**
+     * Constructing empty arena.
+     *
+     * @param table_bytes Size of one table in bytes, rounded up to CACHE_LINE_SIZE
+     * @param policy Policy of allocating chunks
+     * @param max_free_tables Maximal number of released tables kept resident
+     */
+    TableArena(size_t table_bytes, MemoryPolicy policy = MemoryPolicy::CACHE_ALIGNED,
+               size_t max_free_tables = ARENA_MAX_FREE_TABLES);
+
+    /**
+     * Releasing all chunks, tables obtained from arena become invalid.
+     */
+    ~TableArena();
+
+    /**
+     * Obtaining zero-initialized table aligned to CACHE_LINE_SIZE.
+     *
+     * @return Pointer to table
+     */
+    uint8_t *acquire();
+
+    /**
+     * Returning table for reuse. Table does not have to come from this arena, any memory of the same
+     * size which outlives the arena can be given. If max_free_tables released tables are already
+     * resident, pages of the table are returned to the system.
+     *
+     * @param table Pointer to table
+     */
+    void release(uint8_t *table);
+
+    /**
+     * Changing maximal number of released tables kept resident, pages of excess ones are returned
+     * to the system.
+     *
+     * @param max_free_tables Maximal number of released tables kept resident
+     */
+    void setMaxFreeTables(size_t max_free_tables);
+
+    /**
+     * Retrieves number of released tables, resident or not.
+     *
+     * @return number of tables available for reuse
+     */
+    size_t getFreeTables() const;
+
+    /**
+     * Retrieves size of one table including padding.
+     *
+     * @return size of table in bytes
+     */
+    size_t getTableBytes() const;
+
+    /**
+     * Retrieves total size of chunks allocated by arena.
+     *
+     * @return allocated memory in bytes
+     */
+    size_t getAllocatedBytes() const;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "thread_pool.h"
+
+
+ThreadPool::ThreadPool(size_t workers) : next_task_(0) {
+    for (size_t t = 0; t < workers; t++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for (std::thread &worker : workers_) {
+        worker.join();
+    }
+}
+
+
+size_t ThreadPool::getThreadCount() const {
+    return workers_.size() + 1;
+}
+
+
+void ThreadPool::runTasks() {
+    for (size_t k = next_task_.fetch_add(1); k < task_count_; k = next_task_.fetch_add(1)) {
+        (*task_)(k);
+    }
+}
+
+
+void ThreadPool::workerLoop() {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+
+        runTasks();
+
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (--busy_workers_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+
+void ThreadPool::run(size_t count, const std::function<void(size_t)> &task) {
+    if (workers_.empty() || count <= 1) {
+        for (size_t k = 0; k < count; k++) {
+            task(k);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        task_ = &task;
+        task_count_ = count;
+        next_task_ = 0;
+        busy_workers_ = workers_.size();
+        generation_++;
+    }
+    start_.notify_all();
+
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&]() { return busy_workers_ == 0; });
+    task_ = nullptr;
+}
@@ -0,0 +1,80 @@
+#ifndef CUCKOOFILTER_THREAD_POOL_H
+#define CUCKOOFILTER_THREAD_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed pool of worker threads executing one job at a time. Job is a number of independent tasks, which
+ * are taken by workers and by the calling thread, so that a pool without workers runs job sequentially.
+ * Workers sleep while there is no job.
+ */
+class ThreadPool {
+
+private:
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    // signals new job or stopping to workers
+    std::condition_variable start_;
+    // signals end of job to calling thread
+    std::condition_variable done_;
+
+    // current job
+    const std::function<void(size_t)> *task_ = nullptr;
+    size_t task_count_ = 0;
+    std::atomic<size_t> next_task_;
+
+    // number of workers which have not finished current job yet
+    size_t busy_workers_ = 0;
+    // incremented for every job, so that workers notice it
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+
+    /**
+     * Loop of worker thread, waiting for jobs.
+     */
+    void workerLoop();
+
+    /**
+     * Taking and executing tasks of current job until none is left.
+     */
+    void runTasks();
+
+public:
+    /**
+     * Starting worker threads.
+     *
+     * @param workers Number of worker threads besides the calling thread
+     */
+    explicit ThreadPool(size_t workers);
+
+    /**
+     * Stopping and joining worker threads.
+     */
+    ~ThreadPool();
+
+    /**
+     * Retrieves number of threads executing jobs, including the calling thread.
+     *
+     * @return number of threads
+     */
+    size_t getThreadCount() const;
+
+    /**
+     * Executing task(0), ..., task(count - 1) in parallel and returning after all of them are finished.
+     * Calling thread executes tasks too. Tasks must not throw and only one job can run at a time.
+     *
+     * @param count Number of tasks
+     * @param task Task called with index of task
+     */
+    void run(size_t count, const std::function<void(size_t)> &task);
+};
+
+#endif
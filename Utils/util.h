@@ -1,5 +1,13 @@
+#ifndef CUCKOOFILTER_UTIL_H
+#define CUCKOOFILTER_UTIL_H
+
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <utility>
+
+// number of bits sorted in one pass of radix sort
+#define RADIX_BITS 11
 
 struct Victim {
     uint32_t fp = 0;
@@ -17,3 +25,36 @@ static const size_t highestPowerOfTwo(uint32_t v) {
     v >>= 1;
     return v;
 }
+
+/**
+ * LSD radix sort of 64-bit keys by bits [low_bit, low_bit + bits), RADIX_BITS bits per pass.
+ * Sort is stable and sorted keys end up in keys array.
+ *
+ * @param keys Keys for sorting
+ * @param tmp Buffer of at least n keys
+ * @param n Number of keys
+ * @param low_bit Lowest bit of sorting key
+ * @param bits Number of bits of sorting key
+ */
+static inline void radixSort(uint64_t *keys, uint64_t *tmp, size_t n, unsigned low_bit, unsigned bits) {
+    uint64_t *src = keys, *dst = tmp;
+    const size_t digits = 1 << RADIX_BITS;
+    for (unsigned shift = low_bit; shift < low_bit + bits; shift += RADIX_BITS) {
+        size_t offsets[digits + 1] = {0};
+        for (size_t i = 0; i < n; i++) {
+            offsets[((src[i] >> shift) & (digits - 1)) + 1]++;
+        }
+        for (size_t d = 1; d <= digits; d++) {
+            offsets[d] += offsets[d - 1];
+        }
+        for (size_t i = 0; i < n; i++) {
+            dst[offsets[(src[i] >> shift) & (digits - 1)]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != keys) {
+        memcpy(keys, src, n * sizeof(uint64_t));
+    }
+}
+
+#endif